@@ -0,0 +1,58 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#include <cstdint>  // uintptr_t
+#include "arena.h"
+
+
+/*******************************************************************************
+ * TArena
+ ******************************************************************************/
+
+TArena::TArena(size_t BlockSize) :
+  blockSize(BlockSize), block(0), used(0) {}
+
+TArena::~TArena() {
+  Clear();
+  for(auto b:blocks)
+     delete[] b;
+}
+
+// new[] aligns for fundamental types only: bytes up to the next address aligned to Align.
+static size_t Padding(const char* p, size_t Align) {
+  return -(uintptr_t) p & (Align - 1);
+}
+
+void* TArena::Allocate(size_t Size, size_t Align) {
+  if (Size + Align - 1 > blockSize) {
+     large.push_back(new char[Size + Align - 1]);
+     return large.back() + Padding(large.back(), Align);
+     }
+
+  for(;;) {
+     if (block == blocks.size())
+        blocks.push_back(new char[blockSize]);
+
+     size_t offset = used + Padding(blocks[block] + used, Align);
+     if (offset + Size <= blockSize) {
+        used = offset + Size;
+        return blocks[block] + offset;
+        }
+     block++;
+     used = 0;
+     }
+}
+
+void TArena::Clear(void) {
+  for(auto o = objects.rbegin(); o != objects.rend(); ++o)
+     o->destroy(o->p);
+  objects.clear();
+
+  for(auto l:large)
+     delete[] l;
+  large.clear();
+
+  block = 0;
+  used = 0;
+}
@@ -0,0 +1,46 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#pragma once
+#include <vector>
+#include <cstddef>  // size_t
+#include <new>      // placement new
+#include <utility>  // std::forward
+
+
+/*******************************************************************************
+ * class TArena
+ * monotonic buffer for the scratch objects of one transponder. New() places
+ * objects one after another into blocks, Clear() destroys all of them at once
+ * in reverse order. The blocks are kept for the next transponder.
+ * Not locked, owned by one thread.
+ ******************************************************************************/
+class TArena {
+private:
+  struct TObject {
+     void* p;
+     void (*destroy)(void*);
+     };
+  size_t blockSize;
+  std::vector<char*> blocks;
+  std::vector<char*> large;      // objects bigger than a block, freed by Clear()
+  size_t block;                  // current block
+  size_t used;                   // bytes used in current block
+  std::vector<TObject> objects;  // in order of construction
+  void* Allocate(size_t Size, size_t Align);
+public:
+  TArena(size_t BlockSize = 32768);
+  TArena(const TArena&) = delete;
+  TArena& operator=(const TArena&) = delete;
+  ~TArena();
+
+  template<class T, class... Args> T* New(Args&&... Params) {
+     T* t = new(Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(Params)...);
+     objects.push_back({ t, [](void* p) { static_cast<T*>(p)->~T(); } });
+     return t;
+     }
+
+  void Clear(void);
+  int Count(void) const { return objects.size(); }
+};
@@ -3,9 +3,13 @@
  * See the README file for copyright information and how to reach the author.
  ******************************************************************************/
 #include <thread>               // std::this_thread
+#include <chrono>               // std::chrono::steady_clock
+#include <mutex>                // std::mutex
+#include <vector>
+#include <map>
 #include <string>
 #include <iostream>
-#include <algorithm>            // std::min
+#include <algorithm>            // std::min, std::find
 #include <sstream>              // std::stringstream
 #include <ctime>                // time_t, strftime
 #include <syslog.h>             // syslog()
@@ -49,6 +53,8 @@ cMySetup::cMySetup(void) {
   ParseLCN             = false;
   SignalWaitTime       = 1;
   LockTimeout          = 3;
+  ParallelScan         = false;            /* one device only               */
+  TransponderDB        = 1;                /* use known transponders first  */
 }
 
 void cMySetup::InitSystems(void) {
@@ -295,15 +301,22 @@ void TParams::Print(std::string& dest, char Source) {
  * class TChannel, internal channel representation.
  ******************************************************************************/
 TChannel::TChannel() :
-     Name("???"), Shortname(""), Provider(""), Frequency(0),
-     Bandwidth(8), FEC(999), FEC_low(999), Guard(999), Polarization(0),
-     Inversion(999), Modulation(2), Pilot(999), Rolloff(999),
-     StreamId(0), SystemId(0), DelSys(0), Transmission(999),
-     MISO(0), Hierarchy(999), Symbolrate(0), PCR(0), TPID(0),
-     SID(0), ONID(0), NID(0), TID(0), RID(0), LCN(-1), LCN_minor(-1), free_CA_mode(0),
-     service_type(0xFFFF), OrbitalPos(0),
+     TTuning(), Name("???"), Shortname(""), Provider(""), PCR(0), TPID(0),
+     SID(0), ONID(0), NID(0), TID(0), RID(0), LCN(-1), LCN_minor(-1), PMT(0), free_CA_mode(0),
+     service_type(0xFFFF), OrbitalPos(0), West(false),
      reported(false), Tunable(false), Tested(false)
-{}
+{
+  Bandwidth    = 8;
+  FEC          = 999;
+  FEC_low      = 999;
+  Guard        = 999;
+  Inversion    = 999;
+  Modulation   = 2;
+  Pilot        = 999;
+  Rolloff      = 999;
+  Transmission = 999;
+  Hierarchy    = 999;
+}
 
 
 TChannel& TChannel::operator= (const cChannel* rhs) {
@@ -311,7 +324,7 @@ TChannel& TChannel::operator= (const cChannel* rhs) {
   Shortname  = rhs->ShortName();
   Provider   = rhs->Provider();
   Frequency  = rhs->Frequency();
-  Source     = *cSource::ToString(rhs->Source());
+  Source     = rhs->Source();
   Symbolrate = rhs->Srate();
   VPID.PID   = rhs->Vpid();
   VPID.Type  = rhs->Vtype();
@@ -327,7 +340,7 @@ TChannel& TChannel::operator= (const cChannel* rhs) {
      TPid a;
      a.PID = rhs->Apid(i);
      a.Type = rhs->Atype(i);
-     a.Lang = rhs->Alang(i);
+     a.SetLang(rhs->Alang(i));
      APIDs.Add(a);
      }
 
@@ -336,7 +349,7 @@ TChannel& TChannel::operator= (const cChannel* rhs) {
      TPid d;
      d.PID = rhs->Dpid(i);
      d.Type = rhs->Dtype(i);
-     d.Lang = rhs->Dlang(i);
+     d.SetLang(rhs->Dlang(i));
      DPIDs.Add(d);
      }
 
@@ -345,7 +358,7 @@ TChannel& TChannel::operator= (const cChannel* rhs) {
      TPid s;
      s.PID = rhs->Spid(i);
      s.Type = 0;
-     s.Lang = rhs->Slang(i);
+     s.SetLang(rhs->Slang(i));
      SPIDs.Add(s);
      }
 
@@ -377,36 +390,26 @@ TChannel& TChannel::operator= (const cChannel* rhs) {
 }
 
 void TChannel::CopyTransponderData(const TChannel* Channel) {
-  if (Channel) {
-     Frequency    = Channel->Frequency;
-     Source       = Channel->Source;
-     Symbolrate   = Channel->Symbolrate;
-     Bandwidth    = Channel->Bandwidth;
-     FEC          = Channel->FEC;
-     FEC_low      = Channel->FEC_low;
-     Guard        = Channel->Guard;
-     Polarization = Channel->Polarization;
-     Inversion    = Channel->Inversion;
-     Modulation   = Channel->Modulation;
-     Pilot        = Channel->Pilot;
-     Rolloff      = Channel->Rolloff;
-     StreamId     = Channel->StreamId;
-     SystemId     = Channel->SystemId;
-     DelSys       = Channel->DelSys;
-     Transmission = Channel->Transmission;
-     MISO         = Channel->MISO;
-     Hierarchy    = Channel->Hierarchy;
-     }
+  if (Channel)
+     TTuning::operator=(*Channel);
+}
+
+char TChannel::SourceType(void) const {
+  return cSource::ToChar(Source);
+}
+
+std::string TChannel::SourceName(void) const {
+  return *cSource::ToString(Source);
 }
 
 void TChannel::Params(std::string& s) {
   s.clear();
   s.reserve(18 * 4);
 
-  if (Source.size() == 0)
+  if (Source == cSource::stNone)
      return;
 
-  switch(Source[0]) {
+  switch(SourceType()) {
      case 'A':
         if (Inversion != 999)       s += "I" + IntToStr(Inversion);
         if (Modulation != 999)      s += "M" + IntToStr(Modulation);
@@ -444,7 +447,7 @@ void TChannel::Params(std::string& s) {
         if (DelSys and MISO != 999) s += "X" + IntToStr(MISO);
         if (Hierarchy != 999)       s += "Y" + IntToStr(Hierarchy);
         break;
-     default: dlog(0, ": unknown Source " + Source);
+     default: dlog(0, ": unknown Source " + SourceName());
      }
 }
 
@@ -453,7 +456,7 @@ void TChannel::PrintTransponder(std::string& dest) {
   std::string params;
   Params(params);
   int i = Frequency;
-  char source = Source[0];
+  char source = SourceType();
 
   if (i < 1000)    i *= 1000;
   if (i > 999999)  i /= 1000;
@@ -495,7 +498,7 @@ void TChannel::Print(std::string& dest) {
 
   ss << ':' << IntToStr(Frequency)
      << ':' << params
-     << ':' << Source 
+     << ':' << SourceName()
      << ':' << IntToStr(Symbolrate)
      << ':' << IntToStr(VPID.PID);
 
@@ -512,7 +515,7 @@ void TChannel::Print(std::string& dest) {
         else
            ss << ',';
         ss << IntToStr(APIDs[i].PID);
-        if (not APIDs[i].Lang.empty())
+        if (APIDs[i].Lang[0])
            ss << '=' << APIDs[i].Lang;
         if (APIDs[i].Type)
            ss << '@' << IntToStr(APIDs[i].Type);
@@ -528,7 +531,7 @@ void TChannel::Print(std::string& dest) {
         else
            ss << ',';
         ss << IntToStr(DPIDs[i].PID);
-        if (not DPIDs[i].Lang.empty())
+        if (DPIDs[i].Lang[0])
            ss << '=' << DPIDs[i].Lang;
         if (DPIDs[i].Type)
            ss << '@' << IntToStr(DPIDs[i].Type);
@@ -560,6 +563,16 @@ void TChannel::VdrChannel(cChannel& c) {
   c.Parse(s.c_str());
 }
 
+/* dummy NID and SID skip the ChannelID check in cChannel::Parse(). Set on a
+ * copy: jobs are read by other threads meanwhile, ie. for checkpoints.
+ */
+void TChannel::VdrTransponder(cChannel& c) const {
+  TChannel t(*this);
+  t.NID = 0x2000;
+  t.SID = 0x2000;
+  t.VdrChannel(c);
+}
+
 static bool SourceMatches(int a, int b) {
   static const int SatRotor = cSource::stSat | cSource::st_Any;
   return (a == b or (a == SatRotor and (b & cSource::stSat)));
@@ -573,14 +586,14 @@ bool TChannel::ValidSatIf() {
   if (Setup.DiSEqC) {
      cDiseqc* d;
      for(d = Diseqcs.First(); d; d = Diseqcs.Next(d))
-        if (SourceMatches(d->Source(), cSource::FromString(Source.c_str())) and
+        if (SourceMatches(d->Source(), Source) and
             d->Slof() > f and d->Polarization() == Polarization) {
            f -= d->Lof();
            break;
            }
      if (!d) {
         dlog(0, "no diseqc settings for (" +
-                Source + ", " + IntToStr(Frequency) + ", " + Polarization + ')');
+                SourceName() + ", " + IntToStr(Frequency) + ", " + Polarization + ')');
         return false;
         }
      }
@@ -592,13 +605,199 @@ bool TChannel::ValidSatIf() {
 
   if (f < 950 or f > 2150) {
      dlog(0, "transponder (" +
-             Source + ", " + IntToStr(Frequency) + ", " + Polarization +
+             SourceName() + ", " + IntToStr(Frequency) + ", " + Polarization +
              ") (freq " + IntToStr(f) + " -> out of tuning range)");
      return false;
      }
   return true;
 }
 
+/* number of the LNB setting (DiSEqC entry, or band and voltage) used for this
+ * transponder, -1 if none. Transponders with the same setting can be tuned
+ * without switching the LNB.
+ */
+int TChannel::LnbSetting() {
+  int f = Frequency;
+
+  while(f > 999999) f /= 1000;
+
+  if (Setup.DiSEqC) {
+     int n = 0;
+     for(cDiseqc* d = Diseqcs.First(); d; d = Diseqcs.Next(d), n++)
+        if (SourceMatches(d->Source(), Source) and
+            d->Slof() > f and d->Polarization() == Polarization)
+           return n;
+     return -1;
+     }
+
+  int band = f < Setup.LnbSLOF ? 0 : 1;
+  int voltage = (Polarization == 'H' or Polarization == 'L') ? 1 : 0; // 18V : 13V
+  return 2 * band + voltage;
+}
+
+
+/*******************************************************************************
+ * TChannels
+ ******************************************************************************/
+
+int FormatFreq(int f) {
+  if (f < 1000)   f *= 1000;
+  if (f > 999999) f /= 1000;
+  return (f);
+}
+
+void TChannels::Index(TChannel* p) {
+  if (keys.count(p))
+     return; // same item twice in list.
+  int f = FormatFreq(p->Frequency);
+  index[p->Source].insert(std::make_pair(f, p));
+  keys[p] = std::make_pair(p->Source, f);
+}
+
+void TChannels::Unindex(TChannel* p) {
+  auto k = keys.find(p);
+  if (k == keys.end())
+     return;
+  auto& list = index[k->second.first];
+  auto range = list.equal_range(k->second.second);
+  for(auto it = range.first; it != range.second; ++it) {
+     if (it->second == p) {
+        list.erase(it);
+        break;
+        }
+     }
+  keys.erase(k);
+}
+
+void TChannels::Add(TChannel* p) {
+  const std::lock_guard<TListSharedMutex> lock(m);
+  v.push_back(p);
+  Index(p);
+}
+
+void TChannels::Insert(size_t Index, TChannel* p) {
+  const std::lock_guard<TListSharedMutex> lock(m);
+  v.insert(v.begin() + Index, p);
+  this->Index(p);
+}
+
+void TChannels::Delete(size_t Index) {
+  const std::lock_guard<TListSharedMutex> lock(m);
+  TChannel* p = v[Index];
+  v.erase(v.begin() + Index);
+  if (std::find(v.begin(), v.end(), p) == v.end())
+     Unindex(p);
+}
+
+int TChannels::Remove(TChannel* p) {
+  const std::lock_guard<TListSharedMutex> lock(m);
+  auto it = std::find(v.begin(), v.end(), p);
+  if (it == v.end())
+     return -1;
+  int i = it - v.begin();
+  v.erase(it);
+  if (std::find(v.begin(), v.end(), p) == v.end())
+     Unindex(p);
+  return i;
+}
+
+void TChannels::ClearIndex(void) {
+  index.clear();
+  keys.clear();
+}
+
+void TChannels::Clear(void) {
+  const std::lock_guard<TListSharedMutex> lock(m);
+  v.clear();
+  ClearIndex();
+}
+
+void TChannels::Assign(TChannels& from) {
+  Clear();
+  AddList(from);
+}
+
+void TChannels::AddList(TChannels& aList) {
+  const std::lock_guard<TListSharedMutex> lock(m);
+  for(auto p:aList.v) {
+     v.push_back(p);
+     Index(p);
+     }
+}
+
+void TChannels::Reindex(TChannel* p) {
+  const std::lock_guard<TListSharedMutex> lock(m);
+  if (keys.count(p)) {
+     Unindex(p);
+     Index(p);
+     }
+}
+
+
+/*******************************************************************************
+ * cChannelList
+ ******************************************************************************/
+
+static uint64_t IdKey(int ONID, int TSID, int SID) {
+  return (uint64_t) (ONID & 0xFFFF) << 32 | (TSID & 0xFFFF) << 16 | (SID & 0xFFFF);
+}
+
+static uint32_t ServiceKey(int TSID, int SID) {
+  return (TSID & 0xFFFF) << 16 | (SID & 0xFFFF);
+}
+
+template<class K> static void EraseItem(std::unordered_multimap<K,TChannel*>& Map, K Key, TChannel* p) {
+  auto range = Map.equal_range(Key);
+  for(auto it = range.first; it != range.second; ++it) {
+     if (it->second == p) {
+        Map.erase(it);
+        break;
+        }
+     }
+}
+
+void cChannelList::Index(TChannel* p) {
+  if (Indexed(p))
+     return;
+  TChannels::Index(p);
+  byIds.insert(std::make_pair(IdKey(p->ONID, p->TID, p->SID), p));
+  byService.insert(std::make_pair(ServiceKey(p->TID, p->SID), p));
+}
+
+void cChannelList::Unindex(TChannel* p) {
+  if (!Indexed(p))
+     return;
+  TChannels::Unindex(p);
+  EraseItem(byIds, IdKey(p->ONID, p->TID, p->SID), p);
+  EraseItem(byService, ServiceKey(p->TID, p->SID), p);
+}
+
+void cChannelList::ClearIndex(void) {
+  TChannels::ClearIndex();
+  byIds.clear();
+  byService.clear();
+}
+
+TChannel* cChannelList::GetById(int Source, int ONID, int TSID, int SID) {
+  const TListReadLock<TListSharedMutex> lock(m);
+  auto range = byIds.equal_range(IdKey(ONID, TSID, SID));
+
+  for(auto it = range.first; it != range.second; ++it)
+     if (it->second->Source == Source)
+        return it->second;
+  return nullptr;
+}
+
+std::vector<TChannel*> cChannelList::GetByService(int TSID, int SID) {
+  const TListReadLock<TListSharedMutex> lock(m);
+  std::vector<TChannel*> result;
+  auto range = byService.equal_range(ServiceKey(TSID, SID));
+
+  for(auto it = range.first; it != range.second; ++it)
+     result.push_back(it->second);
+  return result;
+}
+
 cDvbDevice* GetDvbDevice(cDevice* d) {
   #ifdef __DYNAMIC_DEVICE_PROBE
      /* vdr/device.h was patched for dynamite plugin */
@@ -618,45 +817,182 @@ void PrintDvbApi(std::string& s) {
       + IntToStr(DVB_API_VERSION_MINOR);
 }
 
-unsigned int GetFrontendStatus(cDevice* dev) {
-  fe_status_t status = FE_NONE;  
+/*******************************************************************************
+ * frontend cache: per adapter/frontend one non-blocking fd for status reads,
+ * and the results of FE_GET_INFO and DTV_ENUM_DELSYS.
+ * While a scan runs, ie. from OpenFrontends() until CloseFrontends(), the fds
+ * are kept open and WaitForLock() uses them without FrontendMutex. Therefore
+ * CloseFrontends() is called only after all scan threads are done. Outside a
+ * scan, an fd is closed as soon as the query is done.
+ ******************************************************************************/
+struct TFrontend {
+  int fd;
+  bool failed;             // open failed, not retried during this scan.
+  bool hasInfo;
+  unsigned int caps;
+  std::vector<int> delsys;
+  TFrontend() : fd(-1), failed(false), hasInfo(false), caps(FE_IS_STUPID) {}
+};
+
+static std::map<std::pair<int,int>, TFrontend> Frontends;
+static std::mutex FrontendMutex;
+static bool KeepOpen = false;
+
+/* with FrontendMutex locked. Opens the fd if needed for status reads or the first query.
+ */
+static TFrontend* GetFrontend(cDevice* dev, bool Status) {
   cDvbDevice* dvbdevice = GetDvbDevice(dev);
-  if (dvbdevice == nullptr) return status; 
+  if (dvbdevice == nullptr) return nullptr;
 
+  TFrontend& f = Frontends[std::make_pair(dvbdevice->Adapter(), dvbdevice->Frontend())];
   std::string s = "/dev/dvb/adapter" + std::to_string(dvbdevice->Adapter()) +
                   "/frontend"        + std::to_string(dvbdevice->Frontend());
 
-  int fe = open(s.c_str(), O_RDONLY | O_NONBLOCK);
-  if (fe < 0)
+  if (f.fd < 0 and !f.failed and (Status or !f.hasInfo) and
+     (f.fd = open(s.c_str(), O_RDONLY | O_NONBLOCK)) < 0) {
      dlog(0, "could not open " + s);
-  else {
-     if (IOCTL(fe, FE_READ_STATUS, &status) < 0)
-        dlog(0, "could not read status: " + s);
-     close(fe);
+     f.failed = true;
      }
-  return status;
+
+  // queried once, on failure caps stays FE_IS_STUPID.
+  if (f.fd >= 0 and !f.hasInfo) {
+     struct dvb_frontend_info fe_info;
+     f.hasInfo = true;
+     if (IOCTL(f.fd, FE_GET_INFO, &fe_info) < 0)
+        dlog(0, "could not query: " + s);
+     else
+        f.caps = fe_info.caps;
+
+     struct dtv_property p;
+     struct dtv_properties cmdseq;
+     memset(&p, 0, sizeof(p));
+     p.cmd = DTV_ENUM_DELSYS;
+     cmdseq.num = 1;
+     cmdseq.props = &p;
+     if (IOCTL(f.fd, FE_GET_PROPERTY, &cmdseq) == 0)
+        for(size_t i = 0; i < p.u.buffer.len; i++)
+           f.delsys.push_back(p.u.buffer.data[i]);
+     }
+  return &f;
 }
 
-unsigned int GetCapabilities(cDevice* dev) {
-  struct dvb_frontend_info fe_info;
-  fe_info.caps = FE_IS_STUPID;
+/* with FrontendMutex locked, after a query: outside a scan, nothing is kept open.
+ */
+static void ReleaseFrontend(TFrontend* f) {
+  if (KeepOpen)
+     return;
+  if (f->fd >= 0)
+     close(f->fd);
+  f->fd = -1;
+  f->failed = false;
+}
 
-  cDvbDevice* dvbdevice = GetDvbDevice(dev);
-  if (dvbdevice == nullptr) return fe_info.caps;
+void OpenFrontends(void) {
+  const std::lock_guard<std::mutex> lock(FrontendMutex);
+  KeepOpen = true;
+}
 
-  std::string s = "/dev/dvb/adapter" + std::to_string(dvbdevice->Adapter()) +
-                  "/frontend"        + std::to_string(dvbdevice->Frontend());
+void CloseFrontends(void) {
+  const std::lock_guard<std::mutex> lock(FrontendMutex);
+  KeepOpen = false;
+  for(auto& it:Frontends)
+     ReleaseFrontend(&it.second);
+}
 
+unsigned int GetFrontendStatus(cDevice* dev) {
+  fe_status_t status = FE_NONE;
+  const std::lock_guard<std::mutex> lock(FrontendMutex);
+  TFrontend* f = GetFrontend(dev, true);
+
+  if (f == nullptr)
+     return status;
+  if (f->fd >= 0 and IOCTL(f->fd, FE_READ_STATUS, &status) < 0)
+     dlog(0, "could not read status: " + DeviceName(dev));
+  ReleaseFrontend(f);
+  return status;
+}
 
-  int fe = open(s.c_str(), O_RDONLY | O_NONBLOCK);
-  if (fe < 0)
-     dlog(0, "could not open " + s);
-  else {
-     if (IOCTL(fe, FE_GET_INFO, &fe_info) < 0)
-        dlog(0, "could not query: " + s);
-     close(fe);
+/* waits after tuning until dev has lock, but not longer than
+ * SignalWaitTime + LockTimeout. Gives up early, if the frontend
+ * has no carrier after SignalWaitTime or reports FE_TIMEDOUT.
+ * If SignalOnly, returns as soon as there is any signal or carrier.
+ */
+bool WaitForLock(cDevice* dev, bool SignalOnly) {
+  int signalTimeout = wSetup.SignalWaitTime * 1000;
+  int lockTimeout   = signalTimeout + wSetup.LockTimeout * 1000;
+  bool lock = false;
+  int fe = -1;
+
+  // the fd is valid until the end of this scan. Outside a scan, VDRs lock state only.
+  {
+  const std::lock_guard<std::mutex> guard(FrontendMutex);
+  TFrontend* f = GetFrontend(dev, true);
+  if (f and KeepOpen)
+     fe = f->fd;
+  else if (f)
+     ReleaseFrontend(f);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  int elapsed = 0;
+
+  for(;;) {
+     // the tuner state of VDR is reset on SwitchChannel(), never outdated.
+     if (dev->HasLock(0)) {
+        lock = true;
+        break;
+        }
+     elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+     if (elapsed >= lockTimeout or (SignalOnly and elapsed >= signalTimeout))
+        break;
+
+     // the frontend status may still belong to the previous transponder for some ms.
+     if (fe >= 0 and elapsed >= 100) {
+        fe_status_t status = FE_NONE;
+        if (IOCTL(fe, FE_READ_STATUS, &status) == 0) {
+           if (SignalOnly and (status & (FE_HAS_SIGNAL | FE_HAS_CARRIER))) {
+              lock = true;
+              break;
+              }
+           if (status & FE_TIMEDOUT)
+              break;
+           if (elapsed >= signalTimeout and !(status & (FE_HAS_SIGNAL | FE_HAS_CARRIER)))
+              break;
+           }
+        }
+     mSleep(10);
      }
-  return fe_info.caps;
+
+  dlog(5, std::string(lock ? "lock" : "no lock") + " after " + IntToStr(elapsed) + "ms");
+  return lock;
+}
+
+unsigned int GetCapabilities(cDevice* dev) {
+  const std::lock_guard<std::mutex> lock(FrontendMutex);
+  TFrontend* f = GetFrontend(dev, false);
+  if (f == nullptr)
+     return FE_IS_STUPID;
+  ReleaseFrontend(f);
+  return f->caps;
+}
+
+/* the delivery systems reported by DTV_ENUM_DELSYS, false if unknown.
+ */
+bool GetDeliverySystems(cDevice* dev, std::vector<int>& Systems) {
+  const std::lock_guard<std::mutex> lock(FrontendMutex);
+  TFrontend* f = GetFrontend(dev, false);
+  if (f == nullptr)
+     return false;
+  ReleaseFrontend(f);
+  Systems = f->delsys;
+  return !Systems.empty();
+}
+
+static bool HasDeliverySystem(cDevice* dev, int DelSys, bool Default) {
+  std::vector<int> systems;
+  if (!GetDeliverySystems(dev, systems))
+     return Default;
+  return std::find(systems.begin(), systems.end(), DelSys) != systems.end();
 }
 
 bool GetTerrCapabilities(cDevice* dev, bool* CodeRate, bool* Modulation, bool* Inversion, bool* Bandwidth, bool* Hierarchy,
@@ -669,7 +1005,7 @@ bool GetTerrCapabilities(cDevice* dev, bool* CodeRate, bool* Modulation, bool* I
   *Hierarchy        = cap & FE_CAN_HIERARCHY_AUTO;
   *TransmissionMode = cap & FE_CAN_GUARD_INTERVAL_AUTO;
   *GuardInterval    = cap & FE_CAN_TRANSMISSION_MODE_AUTO;
-  *DvbT2            = cap & FE_CAN_2G_MODULATION;
+  *DvbT2            = HasDeliverySystem(dev, SYS_DVBT2, cap & FE_CAN_2G_MODULATION);
   return cap != FE_IS_STUPID;
 }
 
@@ -694,7 +1030,7 @@ bool GetSatCapabilities(cDevice* dev, bool* CodeRate, bool* Modulation, bool* Ro
   *CodeRate         = cap & FE_CAN_FEC_AUTO;
   *Modulation       = cap & FE_CAN_QAM_AUTO;
   *RollOff          = 0; /* deprecated: bool* RollOff */
-  *DvbS2            = cap & FE_CAN_2G_MODULATION;
+  *DvbS2            = HasDeliverySystem(dev, SYS_DVBS2, cap & FE_CAN_2G_MODULATION);
   return cap != FE_IS_STUPID;
 }
 
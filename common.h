@@ -6,7 +6,11 @@
 #include <string>
 #include <array>
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include <utility> // std::move
+#include <memory>  // std::unique_ptr
+#include <cstring> // strncpy()
 #include <linux/types.h>
 #include <sys/ioctl.h>
 #include <vdr/diseqc.h>
@@ -96,12 +100,20 @@ public:
  ******************************************************************************/
 class TPid {
 public:
-  TPid() : PID(0), Type(0), Lang("") {}
-  int PID;
-  int Type;
-  std::string Lang;
+  TPid() : PID(0), Type(0) { Lang[0] = 0; }
+  uint16_t PID;
+  uint16_t Type;
+  char Lang[12];           // up to three language codes, separated by '+'
+  void SetLang(const char* s) {
+     strncpy(Lang, s ? s : "", sizeof(Lang) - 1);
+     Lang[sizeof(Lang) - 1] = 0;
+     }
 };
 
+// PIDs and CAIDs of one channel, owned by it.
+typedef TSmallList<TPid,4> TPids;
+typedef TSmallList<int,4>  TCaids;
+
 struct transposer {
   uint8_t  cell_id_extension;
   uint32_t transposer_frequency;
@@ -118,19 +130,44 @@ struct cell {
   struct transposer transposers[16];
 };
 
-class TChannel {
+/* cells of a DVB-T transponder, from the NIT. Most transponders have none,
+ * so they are allocated only when the first one is added.
+ */
+class TCells {
+private:
+  std::unique_ptr<std::vector<struct cell>> cells;
 public:
-  std::string Name;        // ':' replaced by '|', may contain ','
-  std::string Shortname;   // ',' replaced by '.'
-  std::string Provider;
+  TCells(void) {}
+  TCells(const TCells& other) { *this = other; }
+  TCells(TCells&& other) : cells(std::move(other.cells)) {}
+  TCells& operator=(const TCells& other) {
+     if (this != &other)
+        cells.reset(other.cells ? new std::vector<struct cell>(*other.cells) : nullptr);
+     return *this;
+     }
+  void Add(const struct cell& c) {
+     if (!cells)
+        cells.reset(new std::vector<struct cell>);
+     cells->push_back(c);
+     }
+  void Clear(void) { cells.reset(); }
+  int Count(void) const { return cells ? cells->size() : 0; }
+  struct cell& operator[](int Index) { return (*cells)[Index]; }
+};
+
+/* tuning parameters, plain data in one block of 44 bytes: copying and
+ * comparing transponders only touches this part of a TChannel.
+ */
+struct TTuning {
+  int Source;              // cSource code, ie. cSource::stTerr or 'S' with orbital position
   int Frequency;           // S:MHz, C,T: MHz,kHz,Hz
-  int Bandwidth;           // 'B' 1712, 5, 6, 7, 8, 10, DVB-T/DVB-T2 only
-  int FEC;                 // 'C' 0, 12, 23, 34, 35, 45, 56, 67, 78, 89, 910
-  int FEC_low;             // 'D', DVB-T/DVB-T2 only
-  int Guard;               // 'G' 4, 8, 16, 32, 128, 19128, 19256: DVB-T/DVB-T2 only
-  char Polarization;       // 'H', 'V', 'L', 'R'
-  int Inversion;           // 'I' 0, 1 :  DVB-T and DVB-C only
-  int Modulation;          // 'M' 2, 5, 6, 7, 10, 11, 12, 16, 32, 64, 128, 256, 999
+  int Symbolrate;          // DVB-S and DVB-C only
+  int16_t Bandwidth;       // 'B' 1712, 5, 6, 7, 8, 10, DVB-T/DVB-T2 only
+  int16_t FEC;             // 'C' 0, 12, 23, 34, 35, 45, 56, 67, 78, 89, 910
+  int16_t FEC_low;         // 'D', DVB-T/DVB-T2 only
+  int16_t Guard;           // 'G' 4, 8, 16, 32, 128, 19128, 19256: DVB-T/DVB-T2 only
+  int16_t Inversion;       // 'I' 0, 1 :  DVB-T and DVB-C only
+  int16_t Modulation;      // 'M' 2, 5, 6, 7, 10, 11, 12, 16, 32, 64, 128, 256, 999
                            //      2     QPSK (DVB-S, DVB-S2, DVB-T, DVB-T2, ISDB-T)
                            //      5     8PSK (DVB-S, DVB-S2)
                            //      6     16APSK (DVB-S2)
@@ -143,24 +180,31 @@ public:
                            //      64    QAM64 (DVB-C, DVB-T, DVB-T2, ISDB-T)
                            //      128   QAM128 (DVB-C)
                            //      256   QAM256 (DVB-C, DVB-T2)
-  int Pilot;               // 'N' 0, 1, 999: DVB-S2 only
-  int Rolloff;             // 'O' 0, 20, 25, 35
-  int StreamId;            // 'P' 0-255
-  int SystemId;            // 'Q' 0-65535
-  int DelSys;              // 'S' 0, 1
-  int Transmission;        // 'T' 1, 2, 4, 8, 16, 32: DVB-T/DVB-T2 only
-  int MISO;                // 'X' 0 = siso, 1 = miso
-  int Hierarchy;           // 'Y' 0, 1, 2, 4
-  std::string Source;      // as defined in the file sources.conf
-  int Symbolrate;          // DVB-S and DVB-C only
+  int16_t Pilot;           // 'N' 0, 1, 999: DVB-S2 only
+  int16_t Rolloff;         // 'O' 0, 20, 25, 35
+  int StreamId;            // 'P' 0-255, multistream: PLS code and mode in the bits above, as VDR
+  uint16_t SystemId;       // 'Q' 0-65535
+  int16_t DelSys;          // 'S' 0, 1
+  int16_t Transmission;    // 'T' 1, 2, 4, 8, 16, 32: DVB-T/DVB-T2 only
+  int16_t MISO;            // 'X' 0 = siso, 1 = miso
+  int16_t Hierarchy;       // 'Y' 0, 1, 2, 4
+  char Polarization;       // 'H', 'V', 'L', 'R'
+};
+static_assert(sizeof(TTuning) == 44, "TTuning: update the size above");
+
+class TChannel : public TTuning {
+public:
+  std::string Name;        // ':' replaced by '|', may contain ','
+  std::string Shortname;   // ',' replaced by '.'
+  std::string Provider;
   //--
   TPid VPID;               // video PID, type may follow VPID, separated by '='
   int PCR;                 // may follow VPID, separated by '+'
-  TList<TPid> APIDs;       // separated by commas: 101=deu@4. Ends with ';' if Dpids follow.
-  TList<TPid> DPIDs;       // separated by commas: 103=deu@4
+  TPids APIDs;             // separated by commas: 101=deu@4. Ends with ';' if Dpids follow.
+  TPids DPIDs;             // separated by commas: 103=deu@4
   int TPID;                // The teletext PID.  If this channel also carries DVB subtitles,
-  TList<TPid> SPIDs;       //   the DVB subtitling PIDs follow the teletext PID, sep by a ';'
-  TList<int> CAIDs;        // hex int (!) list.
+  TPids SPIDs;             //   the DVB subtitling PIDs follow the teletext PID, sep by a ';'
+  TCaids CAIDs;            // hex int (!) list.
   int SID;                 // Service ID
   int ONID;                // original Network ID
   int NID;                 // Network ID
@@ -176,16 +220,20 @@ public:
   bool reported;
   bool Tunable;
   bool Tested;
-  TList<struct cell> cells;
+  TCells cells;
 public:
   TChannel(void);
   TChannel& operator= (const cChannel* rhs);
   void CopyTransponderData(const TChannel* Channel);
+  char SourceType(void) const;                          // 'A', 'C', 'S' or 'T'
+  std::string SourceName(void) const;                   // as defined in the file sources.conf
   void Params(std::string& s);
   void PrintTransponder(std::string& dest);
   void Print(std::string& dest);
   void VdrChannel(cChannel& c);
+  void VdrTransponder(cChannel& c) const;              // for tuning only, see common.cpp
   bool ValidSatIf(void);
+  int LnbSetting(void);
 };
 
 
@@ -193,10 +241,48 @@ public:
  * class TChannels
  ******************************************************************************/
 bool is_different_transponder_deep_scan(const TChannel* a, const TChannel* b, bool auto_allowed);
+int FormatFreq(int f);
 
-class TChannels : public TList<TChannel*> {
+class TChannels : public TList<TChannel*,TListSharedMutex> {
+private:
+  /* frequency index per source, in FormatFreq() units: MHz for satellite, kHz else.
+   * keys holds the position of each item, to remove it after its frequency changed.
+   */
+  std::map<int,std::multimap<int,TChannel*>> index;
+  std::map<TChannel*,std::pair<int,int>> keys;
+protected:
+  virtual void Index(TChannel* p);                      // m has to be locked by caller.
+  virtual void Unindex(TChannel* p);                    // m has to be locked by caller.
+  virtual void ClearIndex(void);                        // m has to be locked by caller.
+  bool Indexed(TChannel* p) { return keys.count(p) > 0; };
 public:
+  virtual ~TChannels() {}
+  void Add(TChannel* p);
+  void Insert(size_t Index, TChannel* p);
+  void Delete(size_t Index);
+  int  Remove(TChannel* p);
+  void Clear(void);
+  void Assign(TChannels& from);
+  void AddList(TChannels& aList);
+  void Reindex(TChannel* p);                            // call after changing Source or Frequency of an item.
+
+  /* first item of the same source within Delta around t's frequency for
+   * which Match(item) is true, in order of frequency.
+   */
+  template<class F> TChannel* Find(const TChannel* t, unsigned Delta, F Match) {
+     const TListReadLock<TListSharedMutex> lock(m);
+     auto s = index.find(t->Source);
+     if (s == index.end())
+        return nullptr;
+     int f = FormatFreq(t->Frequency);
+     for(auto it = s->second.lower_bound(f - (int) Delta); it != s->second.end() and it->first <= f + (int) Delta; ++it)
+        if (Match(it->second))
+           return it->second;
+     return nullptr;
+     }
+
   TChannel* GetByParams(const TChannel* NewTransponder) {
+     const TListReadLock<TListSharedMutex> lock(m);
      for(auto t:v)
         if (!is_different_transponder_deep_scan(t, NewTransponder, true))
            return t;
@@ -206,6 +292,39 @@ public:
   bool IsUniqueTransponder(const TChannel* NewTransponder) {
      return (GetByParams(NewTransponder) == nullptr);
      }
+
+  TChannel* NextUntested(void) {                        // marks the next untested item as tested and returns it.
+     return NextUntested([](TChannel*) { return false; });
+     }
+
+  template<class F> TChannel* NextUntested(F Skip) {    // as above, leaving untested items for which Skip(item) is true.
+     const std::lock_guard<TListSharedMutex> lock(m);
+     for(auto t:v)
+        if (!t->Tested and !Skip(t)) {
+           t->Tested = true;
+           return t;
+           }
+     return nullptr;
+     }
+};
+
+
+/*******************************************************************************
+ * class cChannelList
+ * channels found by a scan, additionally hashed by (ONID, TSID, SID) and by
+ * (TSID, SID). IDs of an item must not change while it is in the list.
+ ******************************************************************************/
+class cChannelList : public TChannels {
+private:
+  std::unordered_multimap<uint64_t,TChannel*> byIds;      // ONID << 32 | TSID << 16 | SID
+  std::unordered_multimap<uint32_t,TChannel*> byService;  // TSID << 16 | SID
+protected:
+  virtual void Index(TChannel* p);
+  virtual void Unindex(TChannel* p);
+  virtual void ClearIndex(void);
+public:
+  TChannel* GetById(int Source, int ONID, int TSID, int SID); // Source: cSource code
+  std::vector<TChannel*> GetByService(int TSID, int SID);
 };
 
 
@@ -237,6 +356,10 @@ public:
   std::array<std::string,5> preferred;
   int SignalWaitTime;
   int LockTimeout;
+  int ParallelScan;
+  int TransponderDB;
+  std::vector<int> SatList; // next satellite scan: several satellites, if not empty.
+  std::map<int,int> SatRotor; // next satellite scan: rotor positions by sat_list index, instead of sat_list.
 public:
   cMySetup(void);
   void InitSystems(void);
@@ -258,6 +381,7 @@ template<class T> inline void DeleteNullptr(T*& aClass) {
 
 
 cDvbDevice* GetDvbDevice(cDevice* d);
+unsigned int GetCapabilities(cDevice* dev);
 int dvbc_modulation(int index);
 int dvbc_symbolrate(int index);
 void InitSystems(void);
@@ -265,6 +389,10 @@ void InitSystems(void);
 
 void PrintDvbApi(std::string& s);
 unsigned int GetFrontendStatus(cDevice* dev);
+bool GetDeliverySystems(cDevice* dev, std::vector<int>& Systems);
+void OpenFrontends(void);
+void CloseFrontends(void);
+bool WaitForLock(cDevice* dev, bool SignalOnly = false);
 bool GetTerrCapabilities (cDevice* dev, bool* CodeRate, bool* Modulation, bool* Inversion, bool* Bandwidth, bool* Hierarchy, bool* TransmissionMode, bool* GuardInterval, bool* DvbT2);
 bool GetCableCapabilities(cDevice* dev, bool* Modulation, bool* Inversion);
 bool GetAtscCapabilities (cDevice* dev, bool* Modulation, bool* Inversion, bool* VSB, bool* QAM);
@@ -16,6 +16,7 @@
 #include "scanner.h"
 #include "common.h"
 #include "wirbelscan_services.h"
+#include "transponders.h"
 
 using namespace COUNTRY;
 extern cScanner* Scanner;
@@ -30,6 +31,7 @@ std::array<const char*,17> Symbolrates = {tr("AUTO"),"6900","6875","6111","6250"
                                           "6950","7000","6952","5156","5483",tr("ALL (slow)")};
 std::array<const char*,5>  Qams        = {tr("AUTO"),"64","128","256",tr("ALL (slow)")};
 std::array<const char*,2>  inversions  = {tr("AUTO/OFF"),tr("AUTO/ON")};
+std::array<const char*,3>  tpdb_modes  = {tr("off"),tr("known first"),tr("quick (skip dead)")};
 std::array<const char*,3>  atsc_types  = {"VSB (aerial)","QAM (cable)","VSB + QAM (aerial + cable)"};
 std::array<const char*,5>  st          = {"STOP","RUN","No device available - exiting!","No gen2 device available - trying gen1 device"," "};
 
@@ -158,6 +160,8 @@ cMenuSettings::cMenuSettings(void) {
   Add(new cMenuEditStraItem(tr("Source Type"),        &wSetup.DVB_Type,  DVB_Types.size()-1, DVB_Types.data()));
   Add(new cMenuEditIntItem (tr("Signal Wait Time"),   &wSetup.SignalWaitTime, 1, 5));
   Add(new cMenuEditIntItem (tr("Lock Timeout"),       &wSetup.LockTimeout, 1, 10));
+  Add(new cMenuEditBoolItem(tr("Use all devices"),    &wSetup.ParallelScan));
+  Add(new cMenuEditStraItem(tr("Known transponders"), &wSetup.TransponderDB, tpdb_modes.size(), tpdb_modes.data()));
   Add(new cMenuEditIntItem (tr("verbosity"),          &wSetup.verbosity, 0, 6));
   Add(new cMenuEditStraItem(tr("logfile"),            &wSetup.logFile,   logfiles.size(), logfiles.data()));
 
@@ -560,7 +564,7 @@ void stopScanners(void) {
 /*******************************************************************************
  * create new scanner.
  ******************************************************************************/
-bool DoScan(int DVB_Type) {
+bool DoScan(int DVB_Type, bool Resume) {
   if (Scanner && Scanner->Active()) {
      dlog(0, "ERROR: already scanning");
      return false;
@@ -579,11 +583,26 @@ bool DoScan(int DVB_Type) {
      }
   timestamp = time(0);
   channelcount = 0;
-  Scanner = new cScanner("wirbelscan Scanner", DVB_Type);
+  Scanner = new cScanner("wirbelscan Scanner", DVB_Type, Resume);
   return true;
 }
 
 
+/*******************************************************************************
+ * continue an interrupted scan from its last checkpoint.
+ ******************************************************************************/
+bool DoResume(void) {
+  TCheckpoint cp;
+
+  if (!LoadCheckpoint(cp)) {
+     dlog(0, "ERROR: no checkpoint found");
+     return false;
+     }
+  // the scanner takes country and satellite from the checkpoint, not from setup.
+  return DoScan(cp.Type, true);
+}
+
+
 /*******************************************************************************
  * Stop Scanner.
  ******************************************************************************/
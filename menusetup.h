@@ -60,5 +60,6 @@ extern size_t lProgress;
 extern size_t lStrength;
 
 void stopScanners(void);
-bool DoScan(int DVB_Type);
+bool DoScan(int DVB_Type, bool Resume = false);
+bool DoResume(void);
 void DoStop(void);
@@ -7,6 +7,8 @@
 #define B(ID) static const struct __sat_transponder ID[] = {
 #define E(ID) };
 #include <string>
+#include <algorithm>
+#include <cstdlib>
 #include "common.h"
 #include "satellites.h"
 #include "satellites.dat"
@@ -66,6 +68,56 @@ int rotor_position_to_sat_list_index(int rotor_position) {
 }
 
 
+/******************************************************************************
+ * order satellites (list indices) for one sweep of the dish, starting at the
+ * end which is nearer to the current satellite. Uses rotor positions if known
+ * for all of them, orbital positions otherwise. rotor overrides the rotor
+ * positions of sat_list. If the rotor position of the current satellite is
+ * unknown, starts near the selected satellite nearest to it in orbit.
+ *****************************************************************************/
+void sort_by_rotor_position(std::vector<int>& satellites, int current, const std::map<int,int>& rotor) {
+  bool useRotor = true;
+
+  if (satellites.size() < 2)
+     return;
+
+  auto orbital = [](int s) -> int {
+     int pos = BCDtoDecimal(sat_list[s].orbital_position);
+     return sat_list[s].west_east_flag == WEST_FLAG ? -pos : pos;
+     };
+  auto rotorPosition = [&rotor](int s) -> int {
+     auto it = rotor.find(s);
+     return it != rotor.end() ? it->second : sat_list[s].rotor_position;
+     };
+
+  for(auto s:satellites)
+     if (rotorPosition(s) < 0)
+        useRotor = false;
+
+  auto position = [&](int s) -> int {
+     return useRotor ? rotorPosition(s) : orbital(s);
+     };
+
+  int start = satellites.front();
+  if (current >= 0 and (size_t) current < SAT_COUNT(sat_list)) {
+     start = current;
+     if (useRotor and rotorPosition(current) < 0) {
+        start = satellites.front();
+        for(auto s:satellites)
+           if (std::abs(orbital(s) - orbital(current)) < std::abs(orbital(start) - orbital(current)))
+              start = s;
+        }
+     }
+  int here = position(start);
+
+  std::stable_sort(satellites.begin(), satellites.end(),
+     [&position](int a, int b) { return position(a) < position(b); });
+
+  if (std::abs(position(satellites.back()) - here) < std::abs(position(satellites.front()) - here))
+     std::reverse(satellites.begin(), satellites.end());
+}
+
+
 /******************************************************************************
  * print list of all satellites
  *****************************************************************************/
@@ -4,6 +4,8 @@
  ******************************************************************************/
 #pragma once
 #include <string>
+#include <vector>
+#include <map>
 #include <cstdint> // uint{8,16,32}_t
 
 
@@ -13,6 +15,7 @@ size_t sat_count(void);
 std::string satellite_to_short_name(size_t idx);
 std::string satellite_to_full_name(size_t idx);
 int rotor_position_to_sat_list_index(int rotor_position);
+void sort_by_rotor_position(std::vector<int>& satellites, int current, const std::map<int,int>& rotor = {});
 void print_satellites(void);
 
 
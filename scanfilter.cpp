@@ -7,10 +7,17 @@
 #include <algorithm>           // std::sort, std::unique
 #include <iostream>
 #include <cmath>               // round()
+#include <mutex>               // std::mutex
+#include <unistd.h>            // close()
+#include <fcntl.h>             // fcntl()
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <vdr/device.h>        // cDevice
 #include <libsi/section.h>
 #include <libsi/descriptor.h>
 #include "scanfilter.h"
+#include "scanstats.h"         // NowMs()
 #include "si_ext.h"
 #include "countries.h"         // COUNTRY::Alpha3()
 
@@ -23,26 +30,25 @@
  ******************************************************************************/
 
 
-extern TSdtData SdtData;
-extern TNitData NitData;
-TChannels NewChannels;
-TChannels NewTransponders;
+cChannelList NewChannels;
+cTransponders NewTransponders;
 TChannels ScannedTransponders;
 std::vector<TChannelListItem> ChannelListItems;
+static std::mutex ChannelListMutex; // ChannelListItems is shared by all devices scanning.
 
 int nextTransponders;
 
+static std::map<uint32_t,TList<sdtservice>> SdtOther; // key: ONID << 16 | TSID
+static std::mutex SdtOtherMutex;
+
 void resetLists(void) { 
+  {
+  const std::lock_guard<std::mutex> lock(SdtOtherMutex);
+  SdtOther.clear();
+  }
   NewChannels.Clear();
   NewTransponders.Clear();
   ScannedTransponders.Clear();
-  SdtData.services.Clear();
-  NitData.frequency_list.Clear();
-  NitData.cell_frequency_links.Clear();
-  NitData.service_types.Clear();
-  for(int i = 0; i < NitData.transport_streams.Count(); i++)
-     delete NitData.transport_streams[i];
-  NitData.transport_streams.Clear();
   nextTransponders = 0;
 
   NewChannels.Capacity(2500);
@@ -50,52 +56,102 @@ void resetLists(void) {
   ScannedTransponders.Capacity(500);
 }
 
+void AddSdtOther(uint16_t ONID, uint16_t TSID, TList<sdtservice>& Services) {
+  const std::lock_guard<std::mutex> lock(SdtOtherMutex);
+  SdtOther[ONID << 16 | TSID].Assign(Services);
+}
+
+bool HasSdtOther(uint16_t ONID, uint16_t TSID) {
+  const std::lock_guard<std::mutex> lock(SdtOtherMutex);
+  return SdtOther.count(ONID << 16 | TSID) > 0;
+}
+
+bool GetSdtOther(uint16_t ONID, uint16_t TSID, TSdtData& Data) {
+  const std::lock_guard<std::mutex> lock(SdtOtherMutex);
+  auto it = SdtOther.find(ONID << 16 | TSID);
+
+  if (it == SdtOther.end())
+     return false;
+
+  TList<sdtservice>& services = it->second;
+  for(int i = 0; i < services.Count(); i++) {
+     bool found = false;
+     for(int j = 0; !found and j < Data.services.Count(); j++)
+        found = Data.services[j].service_id == services[i].service_id;
+     if (!found)
+        Data.services.Add(services[i]);
+     }
+  if (!Data.original_network_id)
+     Data.original_network_id = ONID;
+  return true;
+}
+
+/*******************************************************************************
+ * cTransponders
+ ******************************************************************************/
+void cTransponders::Add(TChannel* t, int Priority) {
+  const std::lock_guard<TListSharedMutex> lock(m);
+  v.push_back(t);
+  Index(t);
+  int lnb = cSource::IsSat(t->Source) ? t->LnbSetting() : 0;
+  queue.push({Priority, lnb, seq++, t});
+}
+
+void cTransponders::Clear(void) {
+  TChannels::Clear();
+  const std::lock_guard<TListSharedMutex> lock(m);
+  queue = std::priority_queue<TQueued>();
+}
+
+TChannel* cTransponders::NextTransponder(void) {
+  const std::lock_guard<TListSharedMutex> lock(m);
+  while(!queue.empty()) {
+     TChannel* t = queue.top().t;
+     queue.pop();
+     if (!t->Tested) {
+        t->Tested = true;
+        return t;
+        }
+     }
+  return nullptr;
+}
+
+
 bool known_transponder(TChannel* newChannel, bool auto_allowed, TChannels* list) {
   if (list == NULL) {
      return (known_transponder(newChannel, auto_allowed, &NewTransponders) ||
              known_transponder(newChannel, auto_allowed, &ScannedTransponders));
      }
 
-
-  for(int idx = 0; idx < list->Count(); ++idx) {
-     TChannel* channel = list->Items(idx);
-
-     if (newChannel->Source[0] != channel->Source[0])
-        continue;
-
-     char c = newChannel->Source[0];
-     if (c == 'T') {
-        if (newChannel->DelSys and (channel->StreamId != newChannel->StreamId))
-           continue; // may be multiple plps.
-        if (newChannel->DelSys != channel->DelSys and !channel->Tunable)
-           continue; // skip freqs with T!=T1, but not those which had success.
-        if (is_nearly_same_frequency(channel, newChannel))
-           return true;
-        }
-     else if (c == 'C') {
-        if (is_nearly_same_frequency(channel, newChannel))
-           return true;
-        }
-     else if (c == 'A') {
-       if (is_nearly_same_frequency(channel, newChannel) &&  channel->Modulation == newChannel->Modulation)
-          return true;
-       }
-     else if (c == 'S') {
-        if (!is_different_transponder_deep_scan(newChannel, channel, auto_allowed))
-           return true;
-        }
-     else
+  // only neighbours in the frequency index are compared.
+  char c = newChannel->SourceType();
+  switch(c) {
+     case 'T':
+        return list->Find(newChannel, 2001, [newChannel](TChannel* channel) {
+           if (newChannel->DelSys and (channel->StreamId != newChannel->StreamId))
+              return false; // may be multiple plps.
+           if (newChannel->DelSys != channel->DelSys and !channel->Tunable)
+              return false; // skip freqs with T!=T1, but not those which had success.
+           return is_nearly_same_frequency(channel, newChannel);
+           }) != nullptr;
+     case 'C':
+        return list->Find(newChannel, 2001, [newChannel](TChannel* channel) {
+           return is_nearly_same_frequency(channel, newChannel);
+           }) != nullptr;
+     case 'A':
+        return list->Find(newChannel, 2001, [newChannel](TChannel* channel) {
+           return is_nearly_same_frequency(channel, newChannel) and channel->Modulation == newChannel->Modulation;
+           }) != nullptr;
+     case 'S':
+        return list->Find(newChannel, 2, [newChannel, auto_allowed](TChannel* channel) {
+           return !is_different_transponder_deep_scan(newChannel, channel, auto_allowed);
+           }) != nullptr;
+     default:
         dlog(0, std::string(__FUNCTION__) + ": source[0] = " + IntToHex((unsigned) c, 2));
      }
   return (false);
 }
 
-int FormatFreq(int f) {
-  if (f < 1000)   f *= 1000;
-  if (f > 999999) f /= 1000;
-  return (f);
-}
-
 bool is_nearly_same_frequency(const TChannel* chan_a, const TChannel* chan_b, unsigned delta) {
   uint32_t diff;
 
@@ -125,7 +181,7 @@ bool is_different_transponder_deep_scan(const TChannel* a, const TChannel* b, bo
   if (a->Source != b->Source)
      return true;
 
-  char asource = a->Source[0];
+  char asource = a->SourceType();
   int maxdelta = 500; //kHz
 
   if (asource == 'S')
@@ -195,18 +251,249 @@ bool is_different_transponder_deep_scan(const TChannel* a, const TChannel* b, bo
         return false;
         }
      default:
-        dlog(0, std::string(__FUNCTION__) + ": unknown source type '" + a->Source + "'");
+        dlog(0, std::string(__FUNCTION__) + ": unknown source type '" + a->SourceName() + "'");
      }
   return true;
 }
 
 
+/*******************************************************************************
+ * cTableAssembler
+ ******************************************************************************/
+
+bool cTableAssembler::Sync(uint8_t TableId, uint16_t Extension, uint8_t Version, uint8_t Number, uint8_t LastNumber, uint16_t Network) {
+  if (Number > LastNumber)
+     return false;
+
+  auto r = tables.emplace((uint64_t) TableId << 32 | (uint64_t) Network << 16 | Extension, TTable());
+  TTable& t = r.first->second;
+
+  if (r.second or t.version != Version or t.last != LastNumber) {
+     t.version = Version;
+     t.last = LastNumber;
+     t.count = 0;
+     memset(t.sections, 0, sizeof(t.sections));
+     }
+
+  if (t.sections[Number / 8] & (1 << (Number % 8)))
+     return false;
+  t.sections[Number / 8] |= 1 << (Number % 8);
+  t.count++;
+  return true;
+}
+
+bool cTableAssembler::Complete(uint8_t TableId, uint16_t Extension, uint16_t Network) {
+  auto it = tables.find((uint64_t) TableId << 32 | (uint64_t) Network << 16 | Extension);
+  return it != tables.end() and it->second.count > it->second.last;
+}
+
+bool cTableAssembler::Complete(uint8_t TableId) {
+  bool any = false;
+  for(auto& t:tables) {
+     if ((t.first >> 32) != TableId)
+        continue;
+     if (t.second.count <= t.second.last)
+        return false;
+     any = true;
+     }
+  return any;
+}
+
+
+/*******************************************************************************
+ * cSectionFilter
+ ******************************************************************************/
+
+cSectionFilter::cSectionFilter(cSectionReader* Reader, int Pid, int Tid, int Mask, cCondWait* Notify) :
+  reader(Reader), pid(Pid), tid(Tid), mask(Mask), fd(-1), started(0), stopped(0), notify(Notify), anyBytes(false)
+{}
+
+cSectionFilter::~cSectionFilter() {
+  Stop();
+}
+
+void cSectionFilter::Start(void) {
+  reader->Add(this);
+}
+
+bool cSectionFilter::TryStart(void) {
+  return reader->Add(this, true);
+}
+
+void cSectionFilter::Stop(void) {
+  reader->Remove(this);
+}
+
+int cSectionFilter::Lifetime(void) {
+  if (!started)
+     return -1;
+  return (stopped ? stopped : NowMs()) - started;
+}
+
+void cSectionFilter::Finished(void) {
+  stopped = NowMs();
+  Finish();
+  if (notify)
+     notify->Signal();
+}
+
+
+/*******************************************************************************
+ * cSectionReader
+ ******************************************************************************/
+
+cSectionReader::cSectionReader(cDevice* Device) :
+  device(Device), exited(false), overflows(0)
+{
+  epfd = epoll_create1(EPOLL_CLOEXEC);
+  if (epfd < 0)
+     dlog(0, "cSectionReader: epoll_create1 failed");
+
+  // data.ptr nullptr: not a filter.
+  wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wakefd < 0)
+     dlog(0, "cSectionReader: eventfd failed");
+  else if (epfd >= 0) {
+     struct epoll_event ev;
+     ev.events = EPOLLIN;
+     ev.data.ptr = nullptr;
+     epoll_ctl(epfd, EPOLL_CTL_ADD, wakefd, &ev);
+     }
+  Start();
+}
+
+cSectionReader::~cSectionReader() {
+  Cancel();
+  while(!exited) {
+     Wakeup();
+     mSleep(1);
+     }
+  for(auto f:filters)
+     Close(f);
+  filters.clear();
+  if (epfd >= 0)
+     close(epfd);
+  if (wakefd >= 0)
+     close(wakefd);
+}
+
+void cSectionReader::Wakeup(void) {
+  uint64_t one = 1;
+  if (wakefd >= 0 and write(wakefd, &one, sizeof(one)) < 0 and errno != EAGAIN)
+     dlog(0, "cSectionReader: could not wake up");
+}
+
+bool cSectionReader::Add(cSectionFilter* Filter, bool MayFail) {
+  const std::lock_guard<std::mutex> lock(m);
+
+  if (std::find(filters.begin(), filters.end(), Filter) != filters.end())
+     return true;
+
+  Filter->started = NowMs();
+  Filter->stopped = 0;
+  Filter->fd = device->OpenFilter(Filter->pid, Filter->tid, Filter->mask);
+  if (Filter->fd < 0 and MayFail)
+     return false;
+  if (Filter->fd >= 0) {
+     // all queued sections are read at once, until EAGAIN.
+     fcntl(Filter->fd, F_SETFL, fcntl(Filter->fd, F_GETFL) | O_NONBLOCK);
+     struct epoll_event ev;
+     ev.events = EPOLLIN;
+     ev.data.ptr = Filter;
+     epoll_ctl(epfd, EPOLL_CTL_ADD, Filter->fd, &ev);
+     }
+  // without fd, it will time out.
+  filters.push_back(Filter);
+  Wakeup();
+  return Filter->fd >= 0;
+}
+
+void cSectionReader::Remove(cSectionFilter* Filter) {
+  const std::lock_guard<std::mutex> lock(m);
+  auto it = std::find(filters.begin(), filters.end(), Filter);
+
+  if (it != filters.end()) {
+     Close(Filter);
+     filters.erase(it);
+     }
+}
+
+/* removed before Done() or Finished(): Lifetime() ends here.
+ */
+void cSectionReader::Close(cSectionFilter* Filter) {
+  if (!Filter->stopped)
+     Filter->stopped = NowMs();
+  if (Filter->fd >= 0) {
+     epoll_ctl(epfd, EPOLL_CTL_DEL, Filter->fd, nullptr);
+     device->CloseFilter(Filter->fd);
+     Filter->fd = -1;
+     }
+}
+
+void cSectionReader::Action(void) {
+  struct epoll_event events[64];
+  unsigned char buffer[4096];
+
+  while(Running()) {
+     // sleep until a section arrives, the next filter times out or Wakeup().
+     int timeout = 1000;
+     {
+     const std::lock_guard<std::mutex> lock(m);
+     uint64_t now = NowMs();
+     for(auto f:filters) {
+        int64_t remaining = (int64_t) (f->started + f->Timeout() + 1) - (int64_t) now;
+        timeout = std::max(0, std::min(timeout, (int) remaining));
+        }
+     }
+
+     int n = epoll_wait(epfd, events, 64, timeout);
+     const std::lock_guard<std::mutex> lock(m);
+
+     // all sections queued on each readable filter.
+     for(int i = 0; i < n; i++) {
+        cSectionFilter* f = (cSectionFilter*) events[i].data.ptr;
+        if (f == nullptr) {
+           uint64_t count;
+           if (read(wakefd, &count, sizeof(count)) < 0 and errno != EAGAIN)
+              dlog(0, "cSectionReader: could not read wakeup");
+           continue;
+           }
+        if (std::find(filters.begin(), filters.end(), f) == filters.end())
+           continue; // removed meanwhile.
+        int nbytes;
+        while((nbytes = device->ReadFilter(f->fd, buffer, sizeof(buffer))) > 0) {
+           f->anyBytes = true;
+           f->Process(buffer, nbytes);
+           if (f->Done(NowMs() - f->started))
+              break;
+           }
+        if (nbytes < 0 and errno == EOVERFLOW)
+           overflows++;
+        }
+
+     uint64_t now = NowMs();
+     for(size_t i = 0; i < filters.size();) {
+        cSectionFilter* f = filters[i];
+        if (f->Done(now - f->started)) {
+           Close(f);
+           filters.erase(filters.begin() + i);
+           f->Finished();
+           }
+        else
+           i++;
+        }
+     }
+  exited = true;
+}
+
+
 /*******************************************************************************
  * cPatScanner
  ******************************************************************************/
 
-cPatScanner::cPatScanner(cDevice* Parent, struct TPatData& Dest) :
-  device(Parent), PatData(Dest), isActive(true), hasPAT(false), anyBytes(false)
+cPatScanner::cPatScanner(cSectionReader* Reader, struct TPatData& Dest, cCondWait* Notify) :
+  cSectionFilter(Reader, SI_EXT::PID_PAT, SI_EXT::TABLE_ID_PAT, 0xFF, Notify),
+  PatData(Dest), isActive(true), hasPAT(false), complete(false)
 {
   PatData.services.Clear();
   PatData.network_PID = 0;
@@ -216,40 +503,25 @@ cPatScanner::cPatScanner(cDevice* Parent, struct TPatData& Dest) :
 }
 
 cPatScanner::~cPatScanner() {
+  Stop();
   isActive = false;
-  wait.Signal();
 }
 
-void cPatScanner::Action(void) {
-  int count = 0;
-  int nbytes = 0;
-  int fd = device->OpenFilter(SI_EXT::PID_PAT, SI_EXT::TABLE_ID_PAT, 0xFF);
-  unsigned char buffer[4096];
-
-  while(Running() && isActive) {
-     if (wait.Wait(10)) {
-        dlog(5, "cPatScanner: received signal");
-        break;
-        }
-     if (count++ > 1000) { // > 10sec
-        dlog(5, "cPatScanner: PAT timeout.");
-        break;
-        }
-     else if ((count > 300) and not(anyBytes)) {
-        dlog(5, "cPatScanner: PAT timeout.");
-        break;
-        }
-     nbytes = device->ReadFilter(fd, buffer, sizeof(buffer));
-     if (nbytes > 0) {
-        anyBytes = true;
-        Process(buffer, nbytes);
-        }
-     if (hasPAT)
-        break;
+bool cPatScanner::Done(int Elapsed) {
+  if (complete)
+     return true;
+  if (Elapsed > 10000 or (Elapsed > 3000 and not(anyBytes))) {
+     dlog(5, "cPatScanner: PAT timeout.");
+     return true;
      }
+  return false;
+}
 
-  device->CloseFilter(fd);
-  fd = -1;
+int cPatScanner::Timeout(void) {
+  return anyBytes ? 10000 : 3000;
+}
+
+void cPatScanner::Finish(void) {
   isActive = false;
 }
 
@@ -261,10 +533,9 @@ void cPatScanner::Process(const unsigned char* Data, int Length) {
      return;
      }
 
-  if (!Sync.Sync(tsPAT.getVersionNumber(), tsPAT.getSectionNumber(), tsPAT.getLastSectionNumber())) {
-     dlog(4, "cPatScanner: wait for PAT Sync");
-     return;
-     }
+  if (!Sync.Sync(tsPAT.getTableId(), tsPAT.getTransportStreamId(), tsPAT.getVersionNumber(),
+                 tsPAT.getSectionNumber(), tsPAT.getLastSectionNumber()))
+     return; // seen before.
 
   if (wSetup.verbosity > 5)
      hexdump("PAT", Data, Length);
@@ -285,8 +556,8 @@ void cPatScanner::Process(const unsigned char* Data, int Length) {
      }
 
   // all parts of PAT seen.
-  if (tsPAT.getSectionNumber() == tsPAT.getLastSectionNumber())
-     hasPAT = true;
+  if (Sync.Complete(SI_EXT::TABLE_ID_PAT))
+     complete = hasPAT = true;
 }
 
 
@@ -294,8 +565,9 @@ void cPatScanner::Process(const unsigned char* Data, int Length) {
  * cPmtScanner
  ******************************************************************************/
 
-cPmtScanner::cPmtScanner(cDevice* Parent, TPmtData* Data) :
-  device(Parent), data(Data), isActive(false), jobDone(false)
+cPmtScanner::cPmtScanner(cSectionReader* Reader, TPmtData* Data, cCondWait* Notify) :
+  cSectionFilter(Reader, Data->program_map_PID, SI_EXT::TABLE_ID_PMT, 0xFF, Notify),
+  data(Data), isActive(true), jobDone(false)
 {
   data->program_number = 0;
   data->PCR_PID = 0;
@@ -308,32 +580,19 @@ cPmtScanner::cPmtScanner(cDevice* Parent, TPmtData* Data) :
 }
 
 cPmtScanner::~cPmtScanner() {
+  Stop();
   isActive = false;
-  wait.Signal();
 }
 
-void cPmtScanner::Action(void) {
-  isActive = true;
-  int count = 0;
-  int nbytes = 0;
-  int fd = device->OpenFilter(data->program_map_PID, SI_EXT::TABLE_ID_PMT, 0xFF);
-  unsigned char buffer[4096];
+bool cPmtScanner::Done(int Elapsed) {
+  return !isActive or Elapsed > 5000;
+}
 
-  while (Running() && isActive) {
-     if (wait.Wait(10)) {
-        break;
-        }
-     if (count++ > 500) { //>5sec
-        isActive = false;
-        break;
-        }
-     nbytes = device->ReadFilter(fd, buffer, sizeof(buffer));
-     if (nbytes > 0)
-        Process(buffer, nbytes);
-     }
+int cPmtScanner::Timeout(void) {
+  return 5000;
+}
 
-  device->CloseFilter(fd);
-  fd = -1;
+void cPmtScanner::Finish(void) {
   jobDone = true;
   isActive = false;
 }
@@ -397,7 +656,7 @@ void cPmtScanner::Process(const unsigned char* Data, int Length) {
                              break;
                           }
                        }
-                    apid.Lang = b;
+                    apid.SetLang(b);
                     }
                     break;
                  default:;
@@ -441,7 +700,7 @@ void cPmtScanner::Process(const unsigned char* Data, int Length) {
                              break;
                           }
                        }
-                    spid.Lang = b;
+                    spid.SetLang(b);
                     data->Spids.Add(spid);
                     }
                     break;
@@ -458,7 +717,7 @@ void cPmtScanner::Process(const unsigned char* Data, int Length) {
               DeleteNullptr(d);
               }
            if (dpid.PID) {
-              dpid.Lang = lang;
+              dpid.SetLang(lang);
               data->Dpids.Add(dpid);
               }
            }
@@ -482,7 +741,7 @@ void cPmtScanner::Process(const unsigned char* Data, int Length) {
            TPid dpid;
            dpid.PID = stream.getPid();
            dpid.Type = SI::AC3DescriptorTag;
-           dpid.Lang = dlang;
+           dpid.SetLang(dlang);
            data->Dpids.Add(dpid);
            //   }
            }
@@ -506,56 +765,48 @@ void cPmtScanner::Process(const unsigned char* Data, int Length) {
  * basically this is cNitFilter from older vdr/nit.{h,c} with some changes
  ******************************************************************************/
 
-cNitScanner::cNitScanner(cDevice* Parent, uint16_t network_PID, TNitData& Data, int Type) :
-  active(true), device(Parent), nit(network_PID), data(Data), type(Type), hasNIT(false),
-  anyBytes(false)
+cNitScanner::cNitScanner(cSectionReader* Reader, uint16_t network_PID, TNitData& Data, int Type, cCondWait* Notify) :
+  cSectionFilter(Reader, network_PID, SI_EXT::TABLE_ID_NIT_ACTUAL, 0xFF, Notify),
+  active(true), nit(network_PID), data(Data), type(Type), hasNIT(false)
 {
-  first_crc32 = 0;
-
   west = Data.West;
   orbital = Data.OrbitalPos;
+  {
+  const std::lock_guard<std::mutex> lock(ChannelListMutex);
+  items = ChannelListItems.size();
+  }
   Start();
 }
 
 cNitScanner::~cNitScanner() {
+  Stop();
   active = false;
-  wait.Signal();
 }
 
-void cNitScanner::Action(void) {
-  int count = 0;
-  int nbytes = 0;
-  int fd = device->OpenFilter(nit, SI_EXT::TABLE_ID_NIT_ACTUAL, 0xFF);
-  unsigned char buffer[4096];
-  size_t items = ChannelListItems.size();
+bool cNitScanner::Done(int Elapsed) {
+  if (!active or hasNIT)
+     return true;
+  if (Elapsed > 40000) {
+     dlog(2, "NIT timeout");
+     return true;
+     }
+  return Elapsed > 18000 and not(anyBytes);
+}
 
-  while(Running() && active) {
-     if (wait.Wait(10)) {
-        break;
-        }
-     if (count++ > 4000) {   // 4000 x 10msec = 40sec
-        dlog(2, "NIT timeout");
-        break;
-        }
-     else if ((count > 1800) and not(anyBytes))
-        break;
-     nbytes = device->ReadFilter(fd, buffer, sizeof(buffer));
-     if (nbytes > 0) {
-        anyBytes = true;
-        Process(buffer, nbytes);
-        }
-     if (hasNIT) {
-        if (ChannelListItems.size() > items) {
-           // new ChannelListItems, remove duplicates.
-           std::sort(ChannelListItems.begin(), ChannelListItems.end());
-           auto first_duplicate = std::unique(ChannelListItems.begin(), ChannelListItems.end());
-           ChannelListItems.erase(first_duplicate, ChannelListItems.end());
-           }
-        break;
+int cNitScanner::Timeout(void) {
+  return anyBytes ? 40000 : 18000;
+}
+
+void cNitScanner::Finish(void) {
+  if (hasNIT) {
+     const std::lock_guard<std::mutex> lock(ChannelListMutex);
+     if (ChannelListItems.size() > items) {
+        // new ChannelListItems, remove duplicates.
+        std::sort(ChannelListItems.begin(), ChannelListItems.end());
+        auto first_duplicate = std::unique(ChannelListItems.begin(), ChannelListItems.end());
+        ChannelListItems.erase(first_duplicate, ChannelListItems.end());
         }
      }
-  device->CloseFilter(fd);
-  Cancel();
   active = false;
 }
 
@@ -619,6 +870,7 @@ bool GetLCN(TChannel* c) {
   if (c == nullptr)
      return false;
 
+  const std::lock_guard<std::mutex> lock(ChannelListMutex);
   for(auto& it:ChannelListItems) {
      if (((it.original_network_id == c->ONID) or (it.network_id == c->NID)) and
          (it.transport_stream_id == c->TID ) and
@@ -682,6 +934,7 @@ void cNitScanner::ParseCellFrequencyLinks(uint16_t network_id, const unsigned ch
 }
 
 void cNitScanner::Process(const unsigned char* Data, int Length) {
+  const std::lock_guard<std::mutex> lock(ChannelListMutex);
   SI::NIT nit(Data, false);
 
   if (!nit.CheckCRCAndParse())
@@ -691,16 +944,9 @@ void cNitScanner::Process(const unsigned char* Data, int Length) {
       Data[0] != SI_EXT::TABLE_ID_NIT_OTHER)
      return;
 
-  int len = nit.getLength();
-  uint32_t crc32 = Data[len-4] << 24 | Data[len-3] << 16 | Data[len-2] << 8 | Data[len-1];
-
-  if (first_crc32 == crc32) {
-     hasNIT = true;
-     return;
-     }
-
-  if (!first_crc32)
-     first_crc32 = crc32;
+  if (!Sync.Sync(nit.getTableId(), nit.getNetworkId(), nit.getVersionNumber(),
+                 nit.getSectionNumber(), nit.getLastSectionNumber()))
+     return; // seen before.
 
   if (wSetup.verbosity > 5)
      hexdump(__PRETTY_FUNCTION__, Data, Length);
@@ -827,7 +1073,7 @@ void cNitScanner::Process(const unsigned char* Data, int Length) {
               transponder->NID = nit.getNetworkId();
               transponder->ONID = ts.getOriginalNetworkId();
               transponder->TID = ts.getTransportStreamId();
-              transponder->Source = *cSource::ToString(Source);
+              transponder->Source = Source;
               transponder->Frequency = Frequency;
               transponder->Symbolrate = SymbolRate;
               transponder->Polarization = Polarization;
@@ -909,7 +1155,7 @@ void cNitScanner::Process(const unsigned char* Data, int Length) {
               transponder->NID = nit.getNetworkId();
               transponder->ONID = ts.getOriginalNetworkId();
               transponder->TID = ts.getTransportStreamId();
-              transponder->Source = "C";
+              transponder->Source = cSource::stCable;
               transponder->Frequency = Frequency;
               transponder->Symbolrate = SymbolRate;
               transponder->Inversion = 999;
@@ -995,7 +1241,7 @@ void cNitScanner::Process(const unsigned char* Data, int Length) {
               transponder->NID = nit.getNetworkId();
               transponder->ONID = ts.getOriginalNetworkId();
               transponder->TID = ts.getTransportStreamId();
-              transponder->Source = *cSource::ToString(Source);
+              transponder->Source = Source;
               transponder->Frequency = Frequency;
               transponder->Symbolrate = 27500;
               transponder->Inversion = 999;
@@ -1034,7 +1280,7 @@ void cNitScanner::Process(const unsigned char* Data, int Length) {
                     transponder->NID        = nit.getNetworkId();
                     transponder->ONID       = ts.getOriginalNetworkId();
                     transponder->TID        = ts.getTransportStreamId();
-                    transponder->Source     = "T";
+                    transponder->Source     = cSource::stTerr;
                     transponder->DelSys     = 1;
                     transponder->Frequency  = 0;
                     transponder->Symbolrate = 27500;
@@ -1483,29 +1729,24 @@ void cNitScanner::Process(const unsigned char* Data, int Length) {
      } // end TS stream loop
 
   // we have all parts of nit seen.
-  if (nit.getSectionNumber() == nit.getLastSectionNumber())
-     active = false;
+  if (Sync.Complete(SI_EXT::TABLE_ID_NIT_ACTUAL))
+     hasNIT = true;
 }
 
 
 
 TChannel* GetByTransponder(const TChannel* Transponder) {
   int maxdelta = 500; // kHz. DVB-C 113MHz vs. 114MHz etc.
-  char source = Transponder->Source[0];
+  char source = Transponder->SourceType();
   if (source == 'S')
      maxdelta = 2;    // MHz. LNB drift
   else if (source == 'T')
      maxdelta = 250;  // kHz -> France (UK: no longer)
 
-  if (NewChannels.Count()) {
-     for(int idx = 0; idx < NewChannels.Count(); ++idx) {
-        TChannel* ch = NewChannels[idx];
-        if (is_nearly_same_frequency(ch, Transponder, maxdelta) &&
-            ch->Source == Transponder->Source &&
-            ch->TID == Transponder->TID &&
-            ch->SID == Transponder->SID) {
-           return (ch);
-           }
+  for(auto ch:NewChannels.GetByService(Transponder->TID, Transponder->SID)) {
+     if (is_nearly_same_frequency(ch, Transponder, maxdelta) &&
+         ch->Source == Transponder->Source) {
+        return (ch);
         }
      }
   return (NULL);
@@ -1516,48 +1757,38 @@ TChannel* GetByTransponder(const TChannel* Transponder) {
 /*******************************************************************************
  * cSdtScanner
  ******************************************************************************/
-cSdtScanner::cSdtScanner(cDevice * Parent, TSdtData& Data) : 
-  active(true), device(Parent), data(Data), hasSDT(false),
-  anyBytes(false)
+cSdtScanner::cSdtScanner(cSectionReader* Reader, TSdtData& Data, cCondWait* Notify) : 
+  // 0x42 SDT actual and 0x46 SDT other.
+  cSectionFilter(Reader, SI_EXT::PID_SDT, SI_EXT::TABLE_ID_SDT_ACTUAL, 0xFB, Notify),
+  active(true), data(Data), anyOther(false), hasSDT(false)
 {
   data.original_network_id = 0;
-  first_crc32 = 0;
   Start();
 }
 
 cSdtScanner::~cSdtScanner() {
+  Stop();
   active = false;
-  wait.Signal();
 }
 
-void cSdtScanner::Action(void) {
-  int count = 0;
-  int nbytes = 0;
-  unsigned char buffer[4096];
-
-  int fd = device->OpenFilter(SI_EXT::PID_SDT, SI_EXT::TABLE_ID_SDT_ACTUAL, 0xFF);
-  while(Running() && active) {
-     if (wait.Wait(10)) {
-        dlog(5, "cSdtScanner: received signal");
-        break;
-        }
-     if (count++ > 4000) { //40sec
-        dlog(2, "SDT timeout");
-        break;
-        }
-     else if ((count > 1800) and not(anyBytes))
-        break;
-     nbytes = device->ReadFilter(fd, buffer, sizeof(buffer));
-     if (nbytes > 0) {
-        anyBytes = true;
-        Process(buffer, nbytes);
-        }
-     if (hasSDT)
-        break;
+/* after SDT actual, open until the SDT other tables seen so far are complete,
+ * the timeout or deletion by the state machine after NIT.
+ */
+bool cSdtScanner::Done(int Elapsed) {
+  if (!active or (hasSDT and anyOther and other.empty()))
+     return true;
+  if (Elapsed > 40000) {
+     dlog(2, "SDT timeout");
+     return true;
      }
+  return Elapsed > 18000 and not(anyBytes);
+}
 
-  device->CloseFilter(fd);
-  fd = -1;
+int cSdtScanner::Timeout(void) {
+  return anyBytes ? 40000 : 18000;
+}
+
+void cSdtScanner::Finish(void) {
   active = false;
 }
 
@@ -1567,18 +1798,16 @@ void cSdtScanner::Process(const unsigned char* Data, int Length) {
   if (!sdt.CheckCRCAndParse())
      return;
 
-  int len = sdt.getLength();
-  uint32_t crc32 = Data[len-4] << 24 | Data[len-3] << 16 | Data[len-2] << 8 | Data[len-1];
-
-  if (first_crc32 == crc32) {
-     hasSDT = true;
-     return;
-     }
+  bool actual = sdt.getTableId() == SI_EXT::TABLE_ID_SDT_ACTUAL;
+  if (!Sync.Sync(sdt.getTableId(), sdt.getTransportStreamId(), sdt.getVersionNumber(),
+                 sdt.getSectionNumber(), sdt.getLastSectionNumber(), actual ? 0 : sdt.getOriginalNetworkId()))
+     return; // seen before.
 
-  if (!first_crc32)
-     first_crc32 = crc32;
+  uint32_t key = sdt.getOriginalNetworkId() << 16 | sdt.getTransportStreamId();
+  TList<sdtservice>& services = actual ? data.services : other[key];
+  anyOther |= !actual;
 
-  if (data.original_network_id == 0)
+  if (actual and data.original_network_id == 0)
      data.original_network_id = sdt.getOriginalNetworkId();
 
   if (wSetup.verbosity > 5)
@@ -1664,16 +1893,28 @@ void cSdtScanner::Process(const unsigned char* Data, int Length) {
         }
      if (service.Name != "") {
         bool found = false;
-        for(int i = 0; i < data.services.Count(); i++) {
-           if (data.services[i].transport_stream_id == service.transport_stream_id and
-               data.services[i].original_network_id == service.original_network_id and
-               data.services[i].service_id          == service.service_id) {
+        for(int i = 0; i < services.Count(); i++) {
+           if (services[i].transport_stream_id == service.transport_stream_id and
+               services[i].original_network_id == service.original_network_id and
+               services[i].service_id          == service.service_id) {
               found = true;
               break;
               }
            }
         if (!found)
-           data.services.Add(service);
+           services.Add(service);
         }
      }
+
+  // SDT other of a transport stream complete, keep it for the scan of this transport stream.
+  if (!actual and Sync.Complete(SI_EXT::TABLE_ID_SDT_OTHER, sdt.getTransportStreamId(), sdt.getOriginalNetworkId())) {
+     AddSdtOther(sdt.getOriginalNetworkId(), sdt.getTransportStreamId(), services);
+     other.erase(key);
+     }
+
+  // all parts of sdt seen.
+  if (!hasSDT and Sync.Complete(SI_EXT::TABLE_ID_SDT_ACTUAL)) {
+     hasSDT = true;
+     Signal();
+     }
 }
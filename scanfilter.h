@@ -6,6 +6,11 @@
 #include <string>
 #include <cstdint>        // uint{8.16,32}_t
 #include <atomic>         // std::atomic<bool>
+#include <queue>          // std::priority_queue
+#include <vector>
+#include <map>
+#include <mutex>
+#include <repfunc.h>      // ThreadBase
 #include <vdr/thread.h>   // cCondWait
 #include <vdr/sections.h> // cSectionSyncer
 #include "tlist.h"        // TList<T>
@@ -17,7 +22,9 @@
  ******************************************************************************/
 class cDevice;
 class TChannel;
+class cTransponders;
 extern int nextTransponders;
+extern cTransponders NewTransponders;
 
 bool known_transponder(TChannel* newChannel, bool auto_allowed, TChannels* list = nullptr);
 bool is_nearly_same_frequency(const TChannel* chan_a, const TChannel* chan_b, unsigned delta = 2001);
@@ -27,15 +34,39 @@ void resetLists(void);
 
 
 /*******************************************************************************
- * class cTransponders
+ * class cTransponders, transponders to be scanned, best ones first.
  ******************************************************************************/
+enum eTransponderPriority {
+  prioCellLink = 0,   // guessed from a cell_frequency_link, params unknown
+  prioTransposer,     // T2 transposer frequency
+  prioCellCenter,     // T2 cell centre frequency
+  prioNit,            // delivery system descriptor, exact params
+  prioNitSameNetwork, // same, ONID of the transponder announcing it
+  prioDefault = prioNit
+};
+
 class cTransponders : public TChannels {
 private:
-protected:
+  struct TQueued {
+     int priority;
+     int lnb;
+     size_t seq;
+     TChannel* t;
+     bool operator<(const TQueued& rhs) const {
+        if (priority != rhs.priority)
+           return priority < rhs.priority;
+        if (lnb != rhs.lnb)
+           return lnb > rhs.lnb; // group by LNB setting
+        return seq > rhs.seq; // FIFO for same priority
+        }
+     };
+  std::priority_queue<TQueued> queue;
+  size_t seq;
 public:
-   bool IsUniqueTransponder(const TChannel* NewTransponder);
-   TChannel* GetByParams(const TChannel* NewTransponder);
-   TChannel* NextTransponder(void);
+  cTransponders(void) : seq(0) {}
+  void Add(TChannel* t, int Priority = prioDefault);
+  void Clear(void);
+  TChannel* NextTransponder(void);          // marks the best untested one as tested and returns it.
 };
 
 
@@ -58,10 +89,10 @@ struct TPmtData {
 
   TPid Vpid;
   int Tpid;
-  TList<TPid> Apids;
-  TList<TPid> Dpids;
-  TList<TPid> Spids;
-  TList<int> Caids;
+  TPids Apids;
+  TPids Dpids;
+  TPids Spids;
+  TCaids Caids;
 };
 
 struct TCell {
@@ -130,64 +161,121 @@ struct TSdtData {
   TList<sdtservice> services;
 };
 
+/* services of the other transport streams of a network, as announced by SDT
+ * other on any transponder scanned before. Stored per (ONID, TSID) once the
+ * table is complete, cleared by resetLists(). GetSdtOther() adds them to Data.
+ */
+void AddSdtOther(uint16_t ONID, uint16_t TSID, TList<sdtservice>& Services);
+bool HasSdtOther(uint16_t ONID, uint16_t TSID);
+bool GetSdtOther(uint16_t ONID, uint16_t TSID, TSdtData& Data);
+
 
 /*******************************************************************************
- * class cPatScanner
+ * class cTableAssembler
+ * version and received sections per table, ie. per (table_id, table_id_extension).
+ * Tables with the same extension on several networks, as SDT other with
+ * transport_stream_id, need the original_network_id as Network.
+ * A table is complete as soon as all sections 0..last_section_number of its
+ * current version were seen, in any order. A new version starts it over.
+ ******************************************************************************/
+class cTableAssembler {
+private:
+  struct TTable {
+     int version;
+     int last;
+     int count;
+     uint8_t sections[32];
+     };
+  std::map<uint64_t,TTable> tables;   // key: table_id << 32 | Network << 16 | table_id_extension
+public:
+  void Reset(void) { tables.clear(); };
+  // true, if this section wasnt seen before and has to be processed.
+  bool Sync(uint8_t TableId, uint16_t Extension, uint8_t Version, uint8_t Number, uint8_t LastNumber, uint16_t Network = 0);
+  bool Complete(uint8_t TableId, uint16_t Extension, uint16_t Network = 0);
+  // all tables with this table_id seen so far are complete, at least one.
+  bool Complete(uint8_t TableId);
+};
+
+
+/*******************************************************************************
+ * class cSectionFilter
+ * a section filter, served by the cSectionReader of its device. Process() and
+ * Done() are called by the readers thread, Finish() once after the filter is
+ * closed. Derived classes have to call Stop() in their destructor.
+ ******************************************************************************/
+class cSectionReader;
+
+class cSectionFilter {
+friend class cSectionReader;
+private:
+  cSectionReader* reader;
+  int pid, tid, mask;
+  int fd;
+  uint64_t started, stopped;
+  cCondWait* notify;
+  void Finished(void);
+protected:
+  bool anyBytes;
+  virtual void Process(const unsigned char* Data, int Length) = 0;
+  virtual bool Done(int Elapsed) = 0;        // Elapsed: msec since Start()
+  virtual int  Timeout(void) = 0;            // msec since Start(), after which Done() is true
+  virtual void Finish(void) {}
+  void Stop(void);
+  void Signal(void) { if (notify) notify->Signal(); };   // wake up the waiting state machine
+public:
+  cSectionFilter(cSectionReader* Reader, int Pid, int Tid, int Mask, cCondWait* Notify);
+  virtual ~cSectionFilter();
+  void Start(void);                          // if the filter cannot be opened, it times out.
+  bool TryStart(void);                       // false, if the filter cannot be opened.
+  int  Lifetime(void);                       // msec from Start() until done, -1 if never started.
+};
+
+
+/*******************************************************************************
+ * class cSectionReader
+ * one thread per device, serving all section filters at once using epoll.
  ******************************************************************************/
-class cPatScanner : public ThreadBase {
+class cSectionReader : public ThreadBase {
 private:
-  class PatSync {
-  private:
-  /* PatSync is the old & down stripped version of cSectionSyncer */
-    int currentVersion;
-    bool synced;
-    uint8_t sections[32];
-    void SetSectionFlag(uint8_t Section, bool On) {
-       if (On)
-          sections[Section / 8] |=  (1 << (Section % 8));
-       else
-          sections[Section / 8] &= ~(1 << (Section % 8));
-       }
-    bool GetSectionFlag(uint8_t Section) {
-       return sections[Section / 8] & (1 << (Section % 8));
-       }
-  public:
-    PatSync(void) { Reset(); }
-    void Reset(void) {
-       currentVersion = -1;
-       synced = false;
-       memset(sections, 0, sizeof(sections));
-       }
-    bool Sync(uint8_t Version, int Number, int LastNumber) {
-       if (Version != currentVersion) {
-          Reset();
-          currentVersion = Version;
-          }
-       if (!synced) {
-          if (Number != 0)
-             return false;
-          else
-             synced = true;
-          }
-       bool Result = !GetSectionFlag(Number);
-       SetSectionFlag(Number, true);
-       return Result;
-       }
-  };
   cDevice* device;
+  int epfd;
+  std::mutex m;
+  std::vector<cSectionFilter*> filters;
+  int wakefd;                                  // eventfd in the epoll set, interrupts epoll_wait().
+  std::atomic<bool> exited;
+  std::atomic<int> overflows;
+  void Close(cSectionFilter* Filter);
+  void Wakeup(void);
+protected:
+  virtual void Action(void);
+public:
+  cSectionReader(cDevice* Device);
+  virtual ~cSectionReader();
+  bool Add(cSectionFilter* Filter, bool MayFail = false);
+  void Remove(cSectionFilter* Filter);
+  int Overflows(void) { return overflows; };   // sections lost so far, demux buffer overflow
+};
+
+
+/*******************************************************************************
+ * class cPatScanner
+ ******************************************************************************/
+class cPatScanner : public cSectionFilter {
+private:
   struct TPatData& PatData;
   std::atomic<bool> isActive;
-  PatSync Sync;
+  cTableAssembler Sync;
   std::string s;
-  cCondWait wait;
   TChannel channel;
   std::atomic<bool> hasPAT;
-  bool anyBytes;
+  std::atomic<bool> complete;
 protected:
   virtual void Process(const unsigned char* Data, int Length);
-  virtual void Action(void);
+  virtual bool Done(int Elapsed);
+  virtual int  Timeout(void);
+  virtual void Finish(void);
 public:
-  cPatScanner(cDevice* Parent, struct TPatData& Dest);
+  cPatScanner(cSectionReader* Reader, struct TPatData& Dest, cCondWait* Notify = nullptr);
   ~cPatScanner();
   bool HasPAT(void) { return hasPAT; };
   bool Active(void) { return isActive; };
@@ -197,19 +285,19 @@ public:
 /*******************************************************************************
  * class cPmtScanner
  ******************************************************************************/
-class cPmtScanner : public ThreadBase {
+class cPmtScanner : public cSectionFilter {
 private:
-  cDevice* device;
   TPmtData* data;
   std::atomic<bool> isActive;
   std::atomic<bool> jobDone;
   std::string s;
-  cCondWait wait;
 protected:
   virtual void Process(const unsigned char* Data, int Length);
-  virtual void Action(void);
+  virtual bool Done(int Elapsed);
+  virtual int  Timeout(void);
+  virtual void Finish(void);
 public:
-  cPmtScanner(cDevice* Parent, TPmtData* Data);
+  cPmtScanner(cSectionReader* Reader, TPmtData* Data, cCondWait* Notify = nullptr);
   ~cPmtScanner();
   bool Active(void) { return isActive; };
   bool Finished(void) { return jobDone; };
@@ -219,26 +307,26 @@ public:
 /*******************************************************************************
  * class cNitScanner
  ******************************************************************************/
-class cNitScanner : public ThreadBase {
+class cNitScanner : public cSectionFilter {
 private:
   std::atomic<bool> active;
-  cDevice* device;
   uint16_t nit;
   std::string s;
-  cCondWait wait;
   TNitData& data;
-  uint32_t first_crc32;
+  cTableAssembler Sync;
   int type;
   std::atomic<bool> hasNIT;
   bool west;
   uint16_t orbital;
-  bool anyBytes;
+  size_t items;
   void ParseCellFrequencyLinks(uint16_t network_id, const unsigned char* Data, TList<TCell>& list);
 protected:
   virtual void Process(const unsigned char* Data, int Length);
-  virtual void Action(void);
+  virtual bool Done(int Elapsed);
+  virtual int  Timeout(void);
+  virtual void Finish(void);
 public:
-  cNitScanner(cDevice* Parent, uint16_t network_PID, TNitData& Data, int Type);
+  cNitScanner(cSectionReader* Reader, uint16_t network_PID, TNitData& Data, int Type, cCondWait* Notify = nullptr);
   ~cNitScanner();
   bool Active(void) { return (active); };
   bool HasNIT(void) { return hasNIT; };
@@ -248,22 +336,23 @@ public:
 /*******************************************************************************
  * class cSdtScanner
  ******************************************************************************/
-class cSdtScanner : public ThreadBase {
+class cSdtScanner : public cSectionFilter {
 private:
   std::atomic<bool> active;
-  cDevice* device;
   TSdtData& data;
   std::string s;
-  cCondWait wait;
-  uint32_t first_crc32;
+  cTableAssembler Sync;
+  std::map<uint32_t,TList<sdtservice>> other; // SDT other, until complete. key: ONID << 16 | TSID
+  bool anyOther;                              // SDT other seen
   std::atomic<bool> hasSDT;
-  bool anyBytes;
 protected:
   virtual void Process(const unsigned char* Data, int Length);
-  virtual void Action(void);
+  virtual bool Done(int Elapsed);
+  virtual int  Timeout(void);
+  virtual void Finish(void);
 public:
-  cSdtScanner(cDevice* Parent, TSdtData& Data);
+  cSdtScanner(cSectionReader* Reader, TSdtData& Data, cCondWait* Notify = nullptr);
   ~cSdtScanner();
   bool Active(void) { return active; };
-  bool SdtNIT(void) { return hasSDT; };
+  bool HasSDT(void) { return hasSDT; };        // SDT actual complete; the filter stays open for SDT other.
 };
@@ -4,6 +4,10 @@
  ******************************************************************************/
 #include <string>
 #include <array>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <unordered_set>
 #include <algorithm>     // std::min()
 #include <vdr/sources.h>
 #include <vdr/device.h>
@@ -14,6 +18,8 @@
 #include "scanfilter.h"
 #include "statemachine.h"
 #include "countries.h"
+#include "transponders.h"
+#include "scanstats.h"
 #include "wirbelscan_services.h"
 #if VDRVERSNUM < 20301
    #error "Your VDR version is too old - STOP."
@@ -23,6 +29,8 @@ using namespace COUNTRY;
 extern const char* WIRBELSCAN_VERSION;
 int initialTransponders;
 cScanner* Scanner = nullptr;
+static const int CheckpointInterval = 60; // seconds
+static std::mutex StatusMutex; // lTransponder, lStrength and OSD, if scanning with several devices.
 
 static unsigned int chan_to_freq(int channel, int channellist) {
   if (channellist == 999)
@@ -60,7 +68,7 @@ static int device_is_preferred(TChannel* Channel, std::string name, bool secondG
 
 
 cDevice* DefaultDevice(TChannel* Channel) {
-  std::string preferred = wSetup.preferred[dmap[*(Channel->Source.c_str())]];
+  std::string preferred = wSetup.preferred[dmap[Channel->SourceType()]];
 
   for(int i=0; i<cDevice::NumDevices(); i++) {
      auto dev = cDevice::GetDevice(i);
@@ -84,18 +92,11 @@ cDevice* GetPreferredDevice(TChannel* Channel) {
 
   std::string s;
   Channel->PrintTransponder(s);
-  dlog(6, "'" + Channel->Source + "' " + s);
+  dlog(6, "'" + Channel->SourceName() + "' " + s);
 
-  // skip ChannelID check in cChannel::Parse()
   // we just want to find a device here, nothing else.
-  int nid = Channel->NID;
-  int sid = Channel->SID;
-  Channel->NID = 0x2000;
-  Channel->SID = 0x2000;
   cChannel c;
-  Channel->VdrChannel(c);
-  Channel->NID = nid;
-  Channel->SID = sid;
+  Channel->VdrTransponder(c);
 
   dlog(4, "testing '" + std::string(*c.ToText()) + "'");
 
@@ -110,12 +111,10 @@ cDevice* GetPreferredDevice(TChannel* Channel) {
         continue;
         }
 
-     if (Channel->Source[0] == 'S' or Channel->Source[0] == 'T') {
+     if (cSource::IsSat(Channel->Source) or cSource::IsTerr(Channel->Source)) {
         ch2nd = &c;
         ch2nd.DelSys = 1;
-        ch2nd.NID = 0x2000;
-        ch2nd.SID = 0x2000;
-        ch2nd.VdrChannel(c);
+        ch2nd.VdrTransponder(c);
         gen2 = dev->ProvidesTransponder(&c);
         }
      else
@@ -146,15 +145,113 @@ cDevice* GetPreferredDevice(TChannel* Channel) {
 }
 
 
+/* all devices, which could scan the same transponders as Primary in parallel.
+ * Primary is always the first item.
+ */
+static std::vector<cDevice*> GetCapableDevices(TChannel* Channel, cDevice* Primary) {
+  std::vector<cDevice*> devices = { Primary };
+  unsigned int caps = GetCapabilities(Primary);
+  bool isSatip = std::string(Primary->DeviceName()).find("SAT>IP") != std::string::npos;
+
+  cChannel c;
+  Channel->VdrTransponder(c);
+
+  for(int i=0; i<cDevice::NumDevices(); i++) {
+     cDevice* dev = cDevice::GetDevice(i);
+     if (!dev or dev == Primary or !dev->ProvidesTransponder(&c))
+        continue;
+     std::string name(dev->DeviceName());
+     if ((name.find("SAT>IP") != std::string::npos) != isSatip)
+        continue;
+     if (dev->Receiving()) {
+        dlog(4, "device " + IntToStr(dev->CardIndex()) + " = " + name + " (busy)");
+        continue;
+        }
+     if ((GetCapabilities(dev) & caps) != caps) {
+        dlog(4, "device " + IntToStr(dev->CardIndex()) + " = " + name + " (less capabilities)");
+        continue;
+        }
+     dlog(4, "device " + IntToStr(dev->CardIndex()) + " = " + name + " (parallel scan)");
+     devices.push_back(dev);
+     }
+  return devices;
+}
+
+
+static void SwitchTransponder(cDevice* Dev, TChannel* Transponder) {
+  cChannel c;
+  Transponder->VdrTransponder(c);
+  Dev->SwitchChannel(&c, false);
+}
+
+/* satellite: keep transponders with the same LNB setting (DiSEqC entry, or band
+ * and voltage) together, so that the LNB is switched once per group only.
+ */
+static void SortByLnbSetting(TChannels& List) {
+  std::vector<std::pair<int,TChannel*>> sorted;
+
+  for(int i=0; i<List.Count(); i++)
+     sorted.push_back({List[i]->LnbSetting(), List[i]});
+
+  std::stable_sort(sorted.begin(), sorted.end(),
+     [](const std::pair<int,TChannel*>& a, const std::pair<int,TChannel*>& b) {
+        return a.first < b.first;
+        });
+
+  List.Clear();
+  for(auto s:sorted)
+     List.Add(s.second);
+}
+
+
+/*******************************************************************************
+ * class cScanWorker
+ ******************************************************************************/
+
+cScanWorker::cScanWorker(cScanner* Parent, cDevice* Dev, bool Probe) :
+  scanner(Parent), dev(Dev), StateMachine(nullptr), probe(Probe)
+{
+  Start();
+}
+
+cScanWorker::~cScanWorker(void) {
+  DeleteNullptr(StateMachine);
+}
+
+bool cScanWorker::Active(void) {
+  return Running();
+}
+
+void cScanWorker::Action(void) {
+  TChannel* t;
+
+  dlog(4, "device " + IntToStr(dev->CardIndex()) + (probe ? ": start probing" : ": start scanning"));
+  while(Running() and scanner->ActionAllowed() and (t = scanner->NextJob()) != nullptr) {
+     // another device may have found this one meanwhile by NIT.
+     if (known_transponder(t, false))
+        scanner->SkipTransponder();
+     else if (probe)
+        scanner->ProbeTransponder(dev, t);
+     else
+        scanner->ScanTransponder(dev, t, StateMachine);
+     scanner->JobDone(t);
+     }
+  dev->DetachAllReceivers();
+  dlog(4, "device " + IntToStr(dev->CardIndex()) + ": done");
+  Cancel();
+}
+
+
 
 /*******************************************************************************
  * class cScanner
  ******************************************************************************/
 
-cScanner::cScanner(const char* Description, int Type) :
-  shouldstop(false), single(false),
+cScanner::cScanner(const char* Description, int Type, bool Resume) :
+  shouldstop(false), single(false), useNit(true),
   status(0), initialTransponders(0), newTransponders(0), thisChannel(-1),
-  type(Type), dev(nullptr), aChannel(nullptr), StateMachine(nullptr)
+  type(Type), dev(nullptr), aChannel(nullptr), scannedBefore(0), foundBefore(0),
+  currentSat(0), resume(Resume), countryIndex(wSetup.CountryIndex), satIndex(wSetup.SatIndex)
 {
   user[0] = user[1] = user[2] = 0; 
   Start();
@@ -167,8 +264,6 @@ cScanner::~cScanner(void) {
 
 void cScanner::SetShouldstop(bool On) {
   shouldstop = On;
-  if (StateMachine)
-     StateMachine->DoStop();
 }
 
 bool cScanner::ActionAllowed(void) {
@@ -181,9 +276,10 @@ bool cScanner::Active(void) {
 
 void cScanner::Progress(void) {
   extern TChannels ScannedTransponders;
-  extern TChannels NewTransponders;
 
-  lProgress = 0.5 + (100.0 * (ThisChannel() + ScannedTransponders.Count()) / (NewTransponders.Count() + InitialTransponders()));
+  // multi satellite scan: progress of the current satellite.
+  lProgress = 0.5 + (100.0 * (ThisChannel() + ScannedTransponders.Count() - scannedBefore) /
+                             (NewTransponders.Count() - foundBefore + InitialTransponders()));
 
   if (!initialTransponders)
      lProgress = 0;
@@ -192,7 +288,8 @@ void cScanner::Progress(void) {
      lProgress = 100;
 
   if (MenuScanning) {
-     MenuScanning->SetCounters(thisChannel + ScannedTransponders.Count(), NewTransponders.Count() + initialTransponders);
+     MenuScanning->SetCounters(thisChannel + ScannedTransponders.Count() - scannedBefore,
+                               NewTransponders.Count() - foundBefore + initialTransponders);
      MenuScanning->SetProgress(lProgress);
      }
 }
@@ -201,10 +298,396 @@ cDvbDevice* cScanner::DvbDevice(void) {
   return GetDvbDevice(dev);
 }
 
+/* adds a copy of Transponder to the scan plan, if not yet planned.
+ */
+bool cScanner::AddJob(TChannel* Transponder) {
+  std::string params;
+  Transponder->Params(params);
+
+  std::string key = IntToStr(Transponder->Source) + ':' + IntToStr(FormatFreq(Transponder->Frequency)) + ':' +
+                    params + ':' + IntToStr(Transponder->Symbolrate) + ':' + IntToStr(Transponder->StreamId);
+  if (!planned.insert(key).second)
+     return false;
+
+  TChannel* job = new TChannel;
+  *job = *Transponder;
+  job->Tested = false;
+  jobs.Add(job);
+  return true;
+}
+
+/* DVB-C: other symbolrates and QAMs on the same frequency, see SkipAlternatives().
+ */
+static bool Alternative(const TChannel* a, const TChannel* b) {
+  return cSource::IsCable(a->Source) and a->Source == b->Source and
+         FormatFreq(a->Frequency) == FormatFreq(b->Frequency);
+}
+
+TChannel* cScanner::NextJob(void) {
+  std::unique_lock<std::mutex> lock(jobMutex);
+  TChannel* t;
+
+  // alternatives of a frequency running on another device are left untested:
+  // they are skipped anyway, if that one locks. Wait for it, if nothing else is left.
+  for(;;) {
+     bool busy = false;
+     t = jobs.NextUntested([this,&busy](TChannel* c) {
+        for(auto r:running)
+           if (Alternative(c, r))
+              return busy = true;
+        return false;
+        });
+     if (t or !busy or !ActionAllowed())
+        break;
+     jobDone.wait_for(lock, std::chrono::milliseconds(100));
+     }
+
+  if (t == nullptr)
+     return t;
+
+  if (!cSource::IsCable(t->Source) or priors.empty()) {
+     running.insert(t);
+     return t;
+     }
+
+  // DVB-C: of all symbolrates and QAMs left for this frequency,
+  // use the one which had most locks in this scan so far.
+  auto hits = [this](TChannel* c) -> int {
+     auto it = priors.find(std::make_pair(c->Symbolrate, c->Modulation));
+     return it == priors.end() ? 0 : it->second;
+     };
+  TChannel* best = t;
+  int bestHits = hits(t);
+
+  for(int i=0; i<jobs.Count(); i++) {
+     TChannel* a = jobs[i];
+     if (a->Tested or !Alternative(a, t))
+        continue;
+     int h = hits(a);
+     if (h > bestHits) {
+        best = a;
+        bestHits = h;
+        }
+     }
+  if (best != t) {
+     t->Tested = false;
+     best->Tested = true;
+     }
+  running.insert(best);
+  return best;
+}
+
+void cScanner::JobDone(TChannel* Job) {
+  {
+  const std::lock_guard<std::mutex> lock(jobMutex);
+  running.erase(Job);
+  }
+  jobDone.notify_all();
+}
+
+/* writes the current state of this scan, so that it may be resumed later on.
+ * Jobs not yet done and transponders not completely scanned are written as
+ * 'still to be scanned'.
+ */
+void cScanner::Checkpoint(void) {
+  extern cChannelList NewChannels;
+  extern TChannels ScannedTransponders;
+  TChannels todo, channels, scanned, found;
+  TCheckpoint cp;
+
+  cp.Type         = type;
+  cp.CountryIndex = countryIndex;
+  cp.SatIndex     = satIndex;
+  cp.Satellite    = currentSat;
+  cp.Satellites   = satellites;
+
+  // copies, as the workers go on meanwhile. The file is written without locks.
+  auto copy = [](TChannels& List, TChannel* t) {
+     TChannel* c = new TChannel;
+     *c = *t;
+     List.Add(c);
+     };
+  {
+  const std::lock_guard<std::mutex> lock(jobMutex);
+  const std::lock_guard<std::mutex> results(ResultsMutex);
+
+  for(int i=0; i<jobs.Count(); i++)
+     if (!jobs[i]->Tested or running.count(jobs[i]))
+        copy(todo, jobs[i]);
+
+  for(int i=0; i<ScannedTransponders.Count(); i++) {
+     TChannel* t = ScannedTransponders[i];
+     if (t->Tested)
+        copy(scanned, t);
+     else if (!known_transponder(t, false, &todo))
+        copy(todo, t);
+     }
+
+  for(int i=0; i<NewTransponders.Count(); i++)
+     if (!NewTransponders[i]->Tested)
+        copy(found, NewTransponders[i]);
+
+  for(int i=0; i<NewChannels.Count(); i++)
+     copy(channels, NewChannels[i]);
+  }
+
+  SaveCheckpoint(cp, todo, channels, scanned, found);
+
+  for(auto l:{ &todo, &channels, &scanned, &found }) {
+     for(int i=0; i<l->Count(); i++)
+        delete (*l)[i];
+     l->Clear();
+     }
+}
+
+/* DVB-C: after lock, no other symbolrate or QAM needs to be tried on this frequency.
+ */
+void cScanner::SkipAlternatives(TChannel* Transponder) {
+  int skipped = 0;
+
+  if (!cSource::IsCable(Transponder->Source))
+     return;
+  {
+  const std::lock_guard<std::mutex> lock(jobMutex);
+  priors[std::make_pair(Transponder->Symbolrate, Transponder->Modulation)]++;
+
+  for(int i=0; i<jobs.Count(); i++) {
+     TChannel* a = jobs[i];
+     if (a->Tested or !Alternative(a, Transponder))
+        continue;
+     a->Tested = true;
+     skipped++;
+     }
+  }
+  if (skipped) {
+     thisChannel += skipped;
+     Progress();
+     dlog(5, "skipped " + IntToStr(skipped) + " other symbolrates/QAMs");
+     }
+}
+
+void cScanner::SkipTransponder(void) {
+  thisChannel++;
+  Progress();
+}
+
+/* the signal doesn't depend on symbolrate, QAM, PLP or the like.
+ */
+static std::string RfKey(const TChannel* t) {
+  return IntToStr(t->Source) + ':' + IntToStr(FormatFreq(t->Frequency)) + ':' + IntToStr(t->Polarization);
+}
+
+void cScanner::ProbeTransponder(cDevice* Dev, TChannel* Transponder) {
+  std::string s;
+  std::string rf = RfKey(Transponder);
+  {
+  const std::lock_guard<std::mutex> lock(jobMutex);
+  auto it = probed.find(rf);
+  if (it != probed.end()) {
+     Transponder->Tunable = it->second;
+     SkipTransponder();
+     return;
+     }
+  }
+
+  Transponder->PrintTransponder(s);
+  {
+  const std::lock_guard<std::mutex> guard(StatusMutex);
+  ++thisChannel;
+  Progress();
+  lTransponder = s;
+  if (MenuScanning)
+     MenuScanning->SetTransponder(Transponder);
+  }
+
+  SwitchTransponder(Dev, Transponder);
+  uint64_t start = NowMs();
+  Transponder->Tunable = WaitForLock(Dev, true);
+  ScanStats.Add("Probe", NowMs() - start);
+
+  {
+  const std::lock_guard<std::mutex> lock(jobMutex);
+  probed[rf] = Transponder->Tunable;
+  }
+
+  if (Transponder->Tunable) {
+     const std::lock_guard<std::mutex> guard(StatusMutex);
+     lStrength = std::min((size_t)Dev->SignalStrength(), (size_t)100);
+     if (MenuScanning)
+        MenuScanning->SetStr(lStrength, false);
+     }
+  dlog(4, s + (Transponder->Tunable ? ": signal" : ": no signal"));
+}
+
+void cScanner::ScanTransponder(cDevice* Dev, TChannel* Transponder, cStateMachine*& Machine) {
+  std::string s;
+  bool lock;
+
+  Transponder->PrintTransponder(s);
+  {
+  const std::lock_guard<std::mutex> guard(StatusMutex);
+  ++thisChannel;
+  lStrength = 0;
+  Progress();
+  lTransponder = s;
+  if (MenuScanning) {
+     MenuScanning->SetTransponder(Transponder);
+     MenuScanning->SetStr(0, false);
+     }
+  }
+
+  SwitchTransponder(Dev, Transponder);
+  uint64_t start = NowMs();
+  lock = WaitForLock(Dev);
+  ScanStats.Add("Scan lock", NowMs() - start);
+
+  if (lock) {
+     {
+     const std::lock_guard<std::mutex> guard(StatusMutex);
+     lStrength = std::min((size_t)Dev->SignalStrength(), (size_t)100);
+     if (MenuScanning)
+        MenuScanning->SetStr(lStrength, lock);
+     }
+     SkipAlternatives(Transponder);
+     // stops by itself, if this scan is stopped.
+     Machine = new cStateMachine(Dev, Transponder, useNit, this);
+     Machine->Wait();
+     DeleteNullptr(Machine);
+     }
+
+  Dev->DetachAllReceivers();
+}
+
+/* put transponders of previous scans first and frequencies without signal last.
+ * In quick mode, frequencies without signal are skipped.
+ */
+void cScanner::UseKnownTransponders(std::string Name) {
+  TChannels known, live, later, plan, others, last;
+
+  if (!LoadTransponders(Name, known))
+     return;
+
+  for(int i=0; i<known.Count(); i++) {
+     if (known[i]->Tunable)
+        live.Add(known[i]);
+     else
+        later.Add(known[i]);
+     }
+
+  if (type == SCAN_SATELLITE)
+     SortByLnbSetting(live);
+
+  plan.Assign(jobs);
+  jobs.Assign(live);
+
+  for(int i=0; i<plan.Count(); i++) {
+     TChannel* t = plan[i];
+     if (known_transponder(t, true, &live))
+        delete t;
+     else if (!known_transponder(t, true, &later))
+        others.Add(t);
+     else if (wSetup.TransponderDB == 2)
+        delete t;
+     else
+        last.Add(t);
+     }
+
+  jobs.AddList(others);
+  jobs.AddList(last);
+  for(int i=0; i<later.Count(); i++)
+     delete later[i];
+
+  dlog(3, "using " + IntToStr(live.Count()) + " known transponders, " +
+          IntToStr(jobs.Count() - live.Count()) + " others");
+  initialTransponders = jobs.Count();
+}
+
+/* merges the results of this scan into the transponders of previous scans.
+ */
+void cScanner::StoreKnownTransponders(std::string Name, TChannels& Dead) {
+  extern TChannels ScannedTransponders;
+  TChannels result, old;
+
+  // all of them are from the same satellite, if any.
+  auto add = [&result, this](TChannel* t, bool Tunable) {
+     if (t->Source != aChannel->Source)
+        return; // multi satellite scan: previous satellite.
+     TChannel* n = new TChannel;
+     n->CopyTransponderData(t);
+     n->OrbitalPos = aChannel->OrbitalPos;
+     n->West       = aChannel->West;
+     n->ONID       = t->ONID;
+     n->NID        = t->NID;
+     n->TID        = t->TID;
+     n->Tunable    = Tunable;
+     result.Add(n);
+     };
+
+  for(int i=0; i<ScannedTransponders.Count(); i++)
+     add(ScannedTransponders[i], ScannedTransponders[i]->Tunable);
+
+  // announced by NIT, but not yet tested.
+  for(int i=0; i<NewTransponders.Count(); i++)
+     if (!NewTransponders[i]->Tested)
+        add(NewTransponders[i], true);
+
+  for(int i=0; i<Dead.Count(); i++)
+     if (!known_transponder(Dead[i], true, &result))
+        add(Dead[i], false);
+
+  LoadTransponders(Name, old);
+  for(int i=0; i<old.Count(); i++) {
+     if (known_transponder(old[i], true, &result))
+        delete old[i];
+     else
+        result.Add(old[i]);
+     }
+
+  if (result.Count())
+     SaveTransponders(Name, result);
+
+  for(int i=0; i<result.Count(); i++)
+     delete result[i];
+}
+
+void cScanner::RunWorkers(std::vector<cDevice*>& Devices, bool Probe) {
+  time_t last = time(0);
+
+  dlog(3, std::string(Probe ? "probing " : "scanning ") + IntToStr(jobs.Count()) +
+          " transponders using " + IntToStr(Devices.size()) + " device(s)");
+
+  for(auto d:Devices)
+     workers.push_back(new cScanWorker(this, d, Probe));
+
+  for(auto w:workers)
+     while(w->Active()) {
+        mSleep(100);
+        if (!Probe and !single and time(0) - last >= CheckpointInterval) {
+           Checkpoint();
+           last = time(0);
+           }
+        }
+
+  for(auto w:workers)
+     delete w;
+  workers.clear();
+}
+
+/* frontends are kept open while this scan runs, and closed on every return of Action().
+ */
+struct TScanFrontends {
+  TScanFrontends()  { OpenFrontends(); }
+  ~TScanFrontends() { CloseFrontends(); }
+};
+
 void cScanner::Action(void) {
+  const TScanFrontends frontends;
   bool crAuto, modAuto, invAuto, bwAuto, hAuto, tmAuto, gAuto, t2Support, roAuto, s2Support, vsbSupport, qamSupport;
-  bool useNit = true;
-  bool isSatip = false;
+  extern TChannels ScannedTransponders;
+  bool probe = false;
+  std::vector<cDevice*> devices;
+  std::string dbname;
+  TChannels dead, resumed;
   int f = 0;
   int mod_parm, modulation_min = 0, modulation_max = 1;
   int sr_parm, dvbc_symbolrate_min = 0, dvbc_symbolrate_max = 1;
@@ -215,8 +698,8 @@ void cScanner::Action(void) {
   int this_channellist = DVBT_DE, this_bandwidth = 8, this_qam = 999, atsc = ATSC_VSB, dvb;
   int qam_no_auto = 0, this_atsc = 0;
   uint16_t frontend_type = SCAN_SATELLITE;
-  std::string country   = country_to_short_name(wSetup.CountryIndex);
-  std::string satellite = satellite_to_short_name(wSetup.SatIndex);
+  std::string country;
+  std::string satellite;
   std::string channelname, shortname;
   int caps_inversion = 0, caps_qam = 999, caps_hierarchy = 0;
   int caps_fec = 999, caps_guard_interval = 999, caps_transmission_mode = 999;
@@ -224,13 +707,70 @@ void cScanner::Action(void) {
   std::string s;
 
   resetLists();
+  ScanStats.Clear();
+  useNit = true;
+  dlog(3, "wirbelscan version " + std::string(WIRBELSCAN_VERSION) +
+          " @ VDR " + std::string(VDRVERSION));
+
+  if (type == SCAN_SATELLITE) {
+     satellites.swap(wSetup.SatList);
+     wSetup.SatList.clear();
+     if (satellites.empty())
+        satellites.push_back(satIndex);
+     else
+        sort_by_rotor_position(satellites, satIndex, wSetup.SatRotor);
+     wSetup.SatRotor.clear();
+     }
+
+  if (resume) {
+     extern cChannelList NewChannels;
+     TCheckpoint cp;
+     TChannels found;
+     if (LoadCheckpoint(cp, &resumed, &NewChannels, &ScannedTransponders, &found) and cp.Type == type) {
+        for(int i=0; i<found.Count(); i++)
+           NewTransponders.Add(found[i]);
+        // country and satellite of the checkpoint, for this scan only.
+        countryIndex = cp.CountryIndex;
+        satIndex     = cp.SatIndex;
+        if (type == SCAN_SATELLITE) {
+           satellites = cp.Satellites;
+           currentSat = cp.Satellite;
+           if (satellites.empty())
+              satellites.push_back(satIndex);
+           }
+        dlog(3, "resuming scan: " + IntToStr(resumed.Count()) + " transponders left, " +
+                IntToStr(NewChannels.Count()) + " channels found so far");
+        }
+     else {
+        dlog(0, "could not read checkpoint - starting a new scan.");
+        resetLists();
+        resume = false;
+        }
+     }
+  country   = country_to_short_name(countryIndex);
+  satellite = satellite_to_short_name(satIndex);
+
+next_satellite:
+  // multi satellite scan: results of previous satellites are kept.
+  if (satellites.size()) {
+     satellite = satellite_to_short_name(satellites[currentSat]);
+     if (satellites.size() > 1)
+        dlog(3, "satellite " + IntToStr(currentSat + 1) + "/" + IntToStr(satellites.size()) + ": " + satellite);
+     }
+  DeleteNullptr(aChannel);
+  planned.clear();
+  probed.clear();
+  priors.clear();
+  devices.clear();
+  dbname.clear();
+  probe = false;
   thisChannel = 0;
   initialTransponders = 0;
+  scannedBefore = ScannedTransponders.Count();
+  foundBefore = NewTransponders.Count();
   dev = nullptr;
   status = 1;
   if (MenuScanning) MenuScanning->SetStatus(status);
-  dlog(3, "wirbelscan version " + std::string(WIRBELSCAN_VERSION) +
-          " @ VDR " + std::string(VDRVERSION));
 
   switch(type) {
      case SCAN_TRANSPONDER: {
@@ -252,7 +792,7 @@ void cScanner::Action(void) {
         switch(t->Type()) {
             case SCAN_TERRESTRIAL:
                dvb = frontend_type    = SCAN_TERRESTRIAL;
-               aChannel->Source       = "T";
+               aChannel->Source       = cSource::stTerr;
                aChannel->Frequency    = t->Frequency();
                aChannel->Inversion    = t->Inversion();
                aChannel->Bandwidth    = t->Bandwidth();
@@ -266,7 +806,7 @@ void cScanner::Action(void) {
                break;
             case SCAN_CABLE:
                dvb = frontend_type = SCAN_CABLE;
-               aChannel->Source       = "C";
+               aChannel->Source       = cSource::stCable;
                aChannel->Frequency    = t->Frequency();
                aChannel->Modulation   = t->Modulation();
                aChannel->Symbolrate   = t->Symbolrate();
@@ -276,7 +816,7 @@ void cScanner::Action(void) {
                break;
             case SCAN_SATELLITE:
                dvb = frontend_type    = SCAN_SATELLITE;
-               aChannel->Source       = sat_list[t->Id()].source_id;
+               aChannel->Source       = cSource::FromString(sat_list[t->Id()].source_id);
                aChannel->West         = sat_list[t->Id()].west_east_flag == WEST_FLAG;
                aChannel->OrbitalPos   = aChannel->West ?
                                          BCDtoDecimal(0x3600) - BCDtoDecimal(sat_list[t->Id()].orbital_position) :
@@ -294,7 +834,7 @@ void cScanner::Action(void) {
             case SCAN_TERRCABLE_ATSC:
                dvb = frontend_type = SCAN_TERRCABLE_ATSC;
                //fixme: vsb vs qam here
-               aChannel->Source       = "A";
+               aChannel->Source       = cSource::stAtsc;
                aChannel->Frequency    = t->Frequency();
                aChannel->Symbolrate   = t->Symbolrate();
                aChannel->Inversion    = t->Inversion();
@@ -362,7 +902,7 @@ void cScanner::Action(void) {
         /* find a dvb-t2 capable device using *some* channel */
         aChannel = new TChannel;
         aChannel->Name         = "???";
-        aChannel->Source       = "T";
+        aChannel->Source       = cSource::stTerr;
         aChannel->Frequency    = 474;
         aChannel->Inversion    = 999;
         aChannel->Bandwidth    = 8;
@@ -468,7 +1008,7 @@ void cScanner::Action(void) {
         /* find a dvb-c capable device using *some* channel */
         aChannel = new TChannel;
         aChannel->Name       = "???";
-        aChannel->Source     = "C";        
+        aChannel->Source     = cSource::stCable;        
         aChannel->Frequency  = 410;
         aChannel->Modulation = 64;
         aChannel->Symbolrate = 6900;
@@ -542,7 +1082,7 @@ void cScanner::Action(void) {
         aChannel = new TChannel;
         size_t ch = 0;
         for(size_t i=0; i<sat_list[this_channellist].item_count; i++) {
-           aChannel->Source = sat_list[this_channellist].source_id;
+           aChannel->Source = cSource::FromString(sat_list[this_channellist].source_id);
            aChannel->Frequency = sat_list[this_channellist].items[i].intermediate_frequency;
            aChannel->Polarization = p[sat_list[this_channellist].items[i].polarization];
            if (aChannel->ValidSatIf()) {
@@ -552,7 +1092,7 @@ void cScanner::Action(void) {
            }
 
         aChannel->Name         = "???";
-        aChannel->Source       = sat_list[this_channellist].source_id;
+        aChannel->Source       = cSource::FromString(sat_list[this_channellist].source_id);
         aChannel->West         = sat_list[this_channellist].west_east_flag == WEST_FLAG;
         aChannel->OrbitalPos   = aChannel->West ?
                                   BCDtoDecimal(0x3600) - BCDtoDecimal(sat_list[this_channellist].orbital_position) :
@@ -570,7 +1110,11 @@ void cScanner::Action(void) {
            aChannel->Modulation = 2;
            aChannel->DelSys     = 0;
            caps_s2 = 0;
-           if ((dev = GetPreferredDevice(aChannel)) == nullptr) {
+           if ((dev = GetPreferredDevice(aChannel)) == nullptr and currentSat > 0) {
+              dlog(0, "No device available for " + satellite + " - skipped.");
+              goto stop;
+              }
+           if (dev == nullptr) {
               dlog(0, "No device available - exiting!");
               if (MenuScanning)
                  MenuScanning->SetStatus((status = 2));
@@ -626,7 +1170,7 @@ void cScanner::Action(void) {
 
         /* TODO: distinguish between atsc vsb && atsc qam */
         aChannel = new TChannel;
-        aChannel->Source = "A";
+        aChannel->Source = cSource::stAtsc;
         aChannel->Frequency = 474;
         aChannel->Modulation = 256;
         aChannel->Symbolrate = 6900;
@@ -690,33 +1234,34 @@ void cScanner::Action(void) {
         return;
      } // end switch type
 
-  if (lDeviceName.compare(0, 6, "SAT>IP") == 0)
-     isSatip = true;
-  if (MenuScanning)
-     MenuScanning->SetStatus((status = 1));
+  if (wSetup.ParallelScan and not single)
+     devices = GetCapableDevices(aChannel, dev);
+  else
+     devices.push_back(dev);
 
-  //count channels.
-  switch(type) {
-     case SCAN_SATELLITE:
-     case SCAN_TRANSPONDER:
-        initialTransponders = channel_max;
-        break;
-     default:
-        // number depends on offset and symbolrates; counting in nested loops is easiest way.
-        for(mod_parm = modulation_min; mod_parm <= modulation_max; mod_parm++)
-           for(channel = channel_min; channel <= channel_max; channel++)
-              for(offs = freq_offset_min; offs <= freq_offset_max; offs++)
-                 for(sr_parm = dvbc_symbolrate_min; sr_parm <= dvbc_symbolrate_max; sr_parm++) {
-                    if ((! chan_to_freq(channel, this_channellist)) ||
-                        (freq_offset(channel, this_channellist, offs) == -1))
-                       continue;
-                    ++initialTransponders;
-                    }
-     } // switch(type)
+  if (wSetup.TransponderDB and not single) {
+     if (type == SCAN_SATELLITE)
+        dbname = satellite;
+     else
+        dbname = aChannel->SourceName() + '-' + country;
+     }
 
+  // devices without a frontend (SAT>IP) cannot be probed for a carrier.
+  probe = not single and GetDvbDevice(dev) != nullptr;
+  if (MenuScanning)
+     MenuScanning->SetStatus((status = 1));
 
-  cChannel c;
+  if (resume) {
+     // continue a previous scan: the remaining plan is taken from the checkpoint.
+     resume = false;
+     jobs.Assign(resumed);
+     resumed.Clear();
+     initialTransponders = jobs.Count();
+     probe = false;
+     goto stop;
+     }
 
+  // build the scan plan: a flat list of unique transponders.
   for(mod_parm = modulation_min; mod_parm <= modulation_max; mod_parm++) {
     for(channel = channel_min; channel <= channel_max; channel++) {
       for(offs = freq_offset_min; offs <= freq_offset_max; offs++)
@@ -763,7 +1308,7 @@ void cScanner::Action(void) {
                 this_bandwidth = bvdr;
                 }
 
-                aChannel->Source = "T";
+                aChannel->Source = cSource::stTerr;
                 aChannel->Frequency = f;
                 aChannel->Symbolrate = 0;
                 aChannel->Inversion = caps_inversion;
@@ -788,8 +1333,6 @@ void cScanner::Action(void) {
                 if (known_transponder(aChannel, false)) {
                    dlog(4, FloatToStr(aChannel->Frequency/1e6, 1, 3, false) +
                         "MHz: skipped (already known transponder)");
-                   thisChannel++;
-                   Progress();
                    continue;
                    }
                 }
@@ -813,7 +1356,7 @@ void cScanner::Action(void) {
                    continue; // demod supports qam_auto, and we had one loop with QAM_AUTO.
                    }
 
-                aChannel->Source = "C";
+                aChannel->Source = cSource::stCable;
                 aChannel->Frequency = f / 1000;
                 aChannel->Symbolrate = dvbc_symbolrate(sr_parm) / 1000;
                 aChannel->Inversion = caps_inversion;
@@ -832,8 +1375,6 @@ void cScanner::Action(void) {
                 if (known_transponder(aChannel, false)) {
                    dlog(4, FloatToStr(aChannel->Frequency/1e3, 1, 3, false) +
                         "MHz: skipped (already known transponder)");
-                   thisChannel++;
-                   Progress();
                    continue;
                    }
                 break;
@@ -841,7 +1382,7 @@ void cScanner::Action(void) {
                 {
                 auto& sat = sat_list[this_channellist];
                 auto& tp = sat.items[channel];
-                aChannel->Source = sat.source_id;
+                aChannel->Source = cSource::FromString(sat.source_id);
                 aChannel->Frequency  = tp.intermediate_frequency;
                 aChannel->Symbolrate = tp.symbol_rate;
                 aChannel->DelSys     = tp.modulation_system == 6 ? 1:0;
@@ -878,8 +1419,6 @@ void cScanner::Action(void) {
                    if (not(caps_s2)) {
                       dlog(4, IntToStr(sat_list[this_channellist].items[channel].intermediate_frequency) +
                               ": skipped (no S2 support)");
-                      thisChannel++;
-                      Progress();
                       continue;
                       }
                    }
@@ -887,7 +1426,6 @@ void cScanner::Action(void) {
                 if (known_transponder(aChannel, false)) {
                    dlog(4, FloatToStr(aChannel->Frequency/1e0, 1, 3, false) +
                         ": skipped (already known transponder)");
-                   thisChannel++;
                    continue;
                    }
                 break;
@@ -920,7 +1458,7 @@ void cScanner::Action(void) {
                       return;
                    } // end switch mod_parm
                 //fixme: vsb vs qam here
-                aChannel->Source = "A";
+                aChannel->Source = cSource::stAtsc;
                 aChannel->Frequency = f / 1000;
                 aChannel->Symbolrate = dvbc_symbolrate(sr_parm) / 1000;
                 aChannel->Modulation = this_atsc;
@@ -938,8 +1476,6 @@ void cScanner::Action(void) {
                 if (known_transponder(aChannel, false)) {
                    dlog(4, FloatToStr(aChannel->Frequency/1e6, 1, 3, false) +
                         "MHz M" + IntToStr(this_atsc) + ": skipped (already known transponder)");
-                   thisChannel++;
-                   Progress();
                    continue;
                    }
                 break;
@@ -950,56 +1486,87 @@ void cScanner::Action(void) {
                 break;
              default:;
              } // end switch type
-          ++thisChannel;
-          lStrength = 0;
-          Progress();
-          lTransponder = s.c_str();
-          if (MenuScanning) {
-             MenuScanning->SetTransponder(aChannel);
-             }
-          aChannel->Tested = false;
-          int nid = aChannel->NID;
-          int sid = aChannel->SID;
-          aChannel->NID = 0x2000;
-          aChannel->SID = 0x2000;
-          aChannel->VdrChannel(c);
-          aChannel->NID = nid;
-          aChannel->SID = sid;          
-          dev->SwitchChannel(&c, false);
-
-          {
-          bool lock;
-
-          if (MenuScanning)
-             MenuScanning->SetStr(0, false);
-
-          mSleep(wSetup.SignalWaitTime * 1000);
-          if (isSatip or GetFrontendStatus(dev) & FE_HAS_SIGNAL) 
-             lock = dev->HasLock(wSetup.LockTimeout * 1000);
-          else
-             lock = false;
-
-          if (lock) {
-             lStrength = std::min((size_t)dev->SignalStrength(), (size_t)100);
-             if (MenuScanning)
-                MenuScanning->SetStr(lStrength, lock);
-             StateMachine = new cStateMachine(dev, aChannel, useNit, this);
-             while(StateMachine && StateMachine->Active())
-                mSleep(100);
-             DeleteNullptr(StateMachine);
-             }
-           }
 
-
-          if (dev)
-             dev->DetachAllReceivers();
+          // queue a copy; probed and scanned later on.
+          if (!AddJob(aChannel))
+             dlog(5, "skipped (duplicate in scan plan)");
           } // end loop sr_parm
        } // end loop channel
     } // end loop mod_parm
+  planned.clear();
+  initialTransponders = jobs.Count();
+
+  if (type == SCAN_SATELLITE)
+     SortByLnbSetting(jobs);
 
+  if (!dbname.empty())
+     UseKnownTransponders(dbname);
 
 stop:
+  if (probe and ActionAllowed()) {
+     // 1st pass: check for a carrier only. Until done, assume that all of them are used.
+     initialTransponders = 2 * jobs.Count();
+     RunWorkers(devices, true);
+
+     // known meanwhile: skipped by the workers, neither without signal nor to be scanned.
+     // Without signal: one entry per frequency, not per symbolrate and QAM tried.
+     std::set<std::string> deadRf;
+     for(int i = jobs.Count() - 1; i >= 0; i--) {
+        TChannel* t = jobs[i];
+        if (known_transponder(t, false)) {
+           jobs.Delete(i);
+           delete t;
+           }
+        else if (!t->Tunable) {
+           jobs.Delete(i);
+           if (t->Tested and deadRf.insert(RfKey(t)).second)
+              dead.Add(t);
+           else
+              delete t;
+           }
+        else
+           t->Tested = false;
+        }
+     initialTransponders = thisChannel + jobs.Count();
+     dlog(3, IntToStr(jobs.Count()) + " frequencies with signal");
+
+     // stopped: frequencies with signal and those not yet probed are left.
+     if (!single and !ActionAllowed())
+        Checkpoint();
+     }
+
+  // 2nd pass: full scan on frequencies with signal.
+  if (ActionAllowed()) {
+     RunWorkers(devices, false);
+     if (!single and !ActionAllowed())
+        Checkpoint(); // stopped: may be resumed later on.
+     }
+
+  for(int i=0; i<jobs.Count(); i++)
+     delete jobs[i];
+  jobs.Clear();
+
+  if (!dbname.empty())
+     StoreKnownTransponders(dbname, dead);
+  for(int i=0; i<dead.Count(); i++)
+     delete dead[i];
+  dead.Clear();
+
+  if (++currentSat < satellites.size() and ActionAllowed()) {
+     if (dev)
+        dev->DetachAllReceivers();
+     goto next_satellite;
+     }
+
+  {
+  uint64_t start = NowMs();
   AddChannels();
+  ScanStats.Add("Add to VDR", NowMs() - start);
+  }
+
+  if (!single and ActionAllowed())
+     RemoveCheckpoint(); // completed.
+
   if (MenuScanning)
      MenuScanning->SetStatus((status = 0));
 
@@ -1021,78 +1588,111 @@ stop:
 #include <vdr/channels.h>
 
 void cScanner::AddChannels(void) {
-  cStateKey WriteState;
-  cChannels* WChannels = (cChannels*) cChannels::GetChannelsWrite(WriteState, 30000);
-
-  extern TChannels NewChannels;
-
-  if (!WChannels)
+  struct TChannelOp {
+     tChannelID id;
+     std::string text;     // removal: old channel, update: new text
+     TChannel* channel;
+     };
+  std::vector<TChannelOp> removals, updates;
+  std::vector<cChannel*> additions;
+  std::vector<std::string> added;
+  std::unordered_set<TChannel*> known;
+
+  extern cChannelList NewChannels;
+
+  int source = NewChannels.Count() ? NewChannels[0]->Source : 0;
+
+  /* the changes are computed from VDRs channels under a read lock, by looking
+   * up each channel in the hash of NewChannels. The write lock is held only
+   * to apply them.
+   */
+  {
+  cStateKey ReadState;
+  const cChannels* RChannels = cChannels::GetChannelsRead(ReadState, 30000);
+  if (!RChannels)
      return;
 
-  for(int i = 0; i < WChannels->Count(); i++) {
-     const cChannel* ch = WChannels->Get(i);
-     TChannel* newCh = nullptr;
-     int source = 0;
-
+  for(const cChannel* ch = RChannels->First(); ch; ch = RChannels->Next(ch)) {
      // is 'ch' known in NewChannels?
-     for(int idx = 0; idx < NewChannels.Count(); idx++) {
-        if (!source)
-            source = cSource::FromString(NewChannels[idx]->Source.c_str());
-
-        if (ch->Nid() != NewChannels[idx]->ONID or
-            ch->Tid() != NewChannels[idx]->TID or
-            ch->Sid() != NewChannels[idx]->SID or
-            ch->Source() != cSource::FromString(NewChannels[idx]->Source.c_str()))
-           continue;
+     TChannel* newCh = NewChannels.GetById(ch->Source(), ch->Nid(), ch->Tid(), ch->Sid());
 
-        // this channel is already known.
-        newCh = NewChannels[idx];
-        break;
+     if (newCh) {
+        known.insert(newCh);
+        if (wSetup.scan_update_existing)
+           updates.push_back({ ch->GetChannelID(), *ch->ToText(), newCh });
         }
-
-
      // existing channel not found by IDs
-     if (wSetup.scan_remove_invalid and !newCh and ch->Source() == source) {
-        dlog(4, "remove invalid channel '" + std::string(*ch->ToText()) + "'");
-        WChannels->Del((cChannel*) ch);
-        i--;
-        continue;
-        }
-
-     // update existing
-     if (wSetup.scan_update_existing and newCh) {
+     else if (wSetup.scan_remove_invalid and ch->Source() == source)
+        removals.push_back({ ch->GetChannelID(), *ch->ToText(), nullptr });
+     }
+  ReadState.Remove(false);
+  }
+
+  // update existing, if modified. Unmodified ones are marked by channel = nullptr.
+  for(auto& u:updates) {
+     std::string s;
+     u.channel->Print(s);
+     if (s == u.text)
+        u.channel = nullptr;
+     else
+        u.text = s;
+     }
+  updates.erase(std::remove_if(updates.begin(), updates.end(),
+                   [](const TChannelOp& u) { return u.channel == nullptr; }),
+                updates.end());
+
+  // new ones, each IDs once.
+  if (wSetup.scan_append_new) {
+     for(auto n:NewChannels.Snapshot()) {
+        if (known.count(n) or
+            NewChannels.GetById(n->Source, n->ONID, n->TID, n->SID) != n)
+           continue;
         std::string s;
-        newCh->Print(s);
-        if (s != *ch->ToText()) {
-           ((cChannel*) ch)->Parse(s.c_str());
-           dlog(4, "updated channel '" + std::string(*ch->ToText()) + "'");
-           }
+        cChannel* c = new cChannel;
+        n->Print(s);
+        c->Parse(s.c_str());
+        additions.push_back(c);
+        added.push_back(s);
         }
      }
 
-  if (wSetup.scan_append_new)
-  for(int i=0; i<NewChannels.Count(); i++) {
-     TChannel* n = NewChannels[i];
-     const cChannel* old = nullptr;
+  if (removals.empty() and updates.empty() and additions.empty())
+     return;
 
-     for(old = WChannels->First(); old; old = WChannels->Next(old)) {
-        if (old->Nid() == n->ONID and
-            old->Tid() == n->TID and
-            old->Sid() == n->SID and
-            *cSource::ToString(old->Source()) == n->Source) {
-           break;
-           }
-        }
+  cStateKey WriteState;
+  cChannels* WChannels = (cChannels*) cChannels::GetChannelsWrite(WriteState, 30000);
 
-     if (!old) {
-        std::string s;
-        cChannel* c = new cChannel;
-        n->Print(s);
-        c->Parse(s.c_str());
-        dlog(4, "Add channel '" + s + "'");
-        WChannels->Add(c);
-        }           
+  if (!WChannels) {
+     for(auto c:additions)
+        delete c;
+     return;
      }
+
+  for(auto& r:removals) {
+     cChannel* ch = WChannels->GetByChannelID(r.id);
+     if (ch)
+        WChannels->Del(ch);
+     }
+  // text: as VDR has it after the update, for the log.
+  for(auto& u:updates) {
+     cChannel* ch = WChannels->GetByChannelID(u.id);
+     if (ch) {
+        ch->Parse(u.text.c_str());
+        u.text = *ch->ToText();
+        }
+     else
+        u.channel = nullptr;
+     }
+  for(auto c:additions)
+     WChannels->Add(c);
   WChannels->ReNumber();
   WriteState.Remove();
+
+  for(auto& r:removals)
+     dlog(4, "remove invalid channel '" + r.text + "'");
+  for(auto& u:updates)
+     if (u.channel)
+        dlog(4, "updated channel '" + u.text + "'");
+  for(auto& a:added)
+     dlog(4, "Add channel '" + a + "'");
 }
@@ -3,31 +3,81 @@
  * See the README file for copyright information and how to reach the author.
  ******************************************************************************/
 #pragma once
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <repfunc.h>
+#include "common.h"   // TChannels
 
 class cDevice;
 class cDvbDevice;
 class TChannel;
 class cStateMachine;
+class cScanner;
 
+/*******************************************************************************
+ * class cScanWorker, scans jobs from cScanner on one device.
+ ******************************************************************************/
+class cScanWorker : public ThreadBase {
+private:
+  cScanner*      scanner;
+  cDevice*       dev;
+  cStateMachine* StateMachine;
+  bool           probe;
+protected:
+  virtual void Action(void);
+public:
+  cScanWorker(cScanner* Parent, cDevice* Dev, bool Probe);
+  virtual ~cScanWorker(void);
+  bool Active(void);
+};
+
+
+/*******************************************************************************
+ * class cScanner
+ ******************************************************************************/
 class cScanner : public ThreadBase {
 private:
   bool       shouldstop;
   bool       single;
+  bool       useNit;
   size_t     user[3];
   int        status;
   int        initialTransponders;
   int        newTransponders;
-  int        thisChannel;
+  std::atomic<int> thisChannel;
   int        type;
   cDevice*   dev;
   TChannel*  aChannel;
-  cStateMachine* StateMachine;
+  TChannels  jobs;
+  std::mutex jobMutex;
+  std::set<std::string> planned;
+  std::map<std::string,bool> probed;         // signal per RF frequency
+  std::map<std::pair<int,int>,int> priors;   // DVB-C: locks per symbolrate and QAM
+  std::vector<cScanWorker*> workers;
+  std::vector<int> satellites;               // sat_list indices, in rotor order
+  int        scannedBefore;
+  int        foundBefore;
+  size_t     currentSat;                     // position in satellites
+  bool       resume;                         // continue from last checkpoint
+  int        countryIndex;                   // wSetup, or the checkpoints on resume
+  int        satIndex;
+  std::set<TChannel*> running;               // jobs claimed, but not yet done
+  std::condition_variable jobDone;           // signaled by JobDone(), with jobMutex
 protected:
   virtual void Action(void);
   void AddChannels(void);
+  void RunWorkers(std::vector<cDevice*>& Devices, bool Probe);
+  void UseKnownTransponders(std::string Name);
+  void StoreKnownTransponders(std::string Name, TChannels& Dead);
+  void SkipAlternatives(TChannel* Transponder);
+  void Checkpoint(void);
 public:
-  cScanner(const char* Description, int Type);
+  cScanner(const char* Description, int Type, bool Resume = false);
   virtual ~cScanner(void);
   virtual void SetShouldstop(bool On);
   virtual bool ActionAllowed(void);
@@ -38,4 +88,10 @@ public:
   int ThisChannel(void)  { return thisChannel; };
   void Progress(void);
   cDvbDevice* DvbDevice(void);
+  bool AddJob(TChannel* Transponder);
+  TChannel* NextJob(void);
+  void JobDone(TChannel* Job);
+  void SkipTransponder(void);
+  void ProbeTransponder(cDevice* Dev, TChannel* Transponder);
+  void ScanTransponder(cDevice* Dev, TChannel* Transponder, cStateMachine*& Machine);
 };
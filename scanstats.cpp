@@ -0,0 +1,162 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#include <chrono>        // std::chrono::steady_clock
+#include <algorithm>     // std::max()
+#include <sstream>       // std::stringstream
+#include <repfunc.h>
+#include "scanstats.h"
+
+
+cScanStats ScanStats;
+
+uint64_t NowMs(void) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/*******************************************************************************
+ * TTimes
+ ******************************************************************************/
+
+void TTimes::Add(const std::string& Name, int Ms) {
+  if (Ms < 0)
+     return;
+  samples.push_back(std::make_pair(Name, Ms));
+  for(auto& t:times) {
+     if (t.first == Name) {
+        t.second.count++;
+        t.second.total += Ms;
+        t.second.max = std::max(t.second.max, (uint32_t) Ms);
+        return;
+        }
+     }
+  TTime t = { 1, (uint32_t) Ms, (uint32_t) Ms };
+  times.push_back(std::make_pair(Name, t));
+}
+
+void TTimes::Clear(void) {
+  transponder.clear();
+  elapsed = 0;
+  times.clear();
+  samples.clear();
+}
+
+
+/*******************************************************************************
+ * THistogram
+ ******************************************************************************/
+
+const uint32_t THistogram::Limits[THistogram::Buckets - 1] = {
+  10, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 60000 };
+
+THistogram::THistogram(const std::string& Name) :
+  name(Name), count(0), total(0), max(0)
+{
+  for(int i = 0; i < Buckets; i++)
+     buckets[i] = 0;
+}
+
+void THistogram::Add(int Ms) {
+  int i = 0;
+  while(i < Buckets - 1 and (uint32_t) Ms > Limits[i])
+     i++;
+  buckets[i]++;
+  count++;
+  total += Ms;
+  max = std::max(max, (uint32_t) Ms);
+}
+
+
+/*******************************************************************************
+ * cScanStats
+ ******************************************************************************/
+
+cScanStats::cScanStats(void) : started(NowMs()) {}
+
+void cScanStats::Clear(void) {
+  const std::lock_guard<std::mutex> lock(m);
+  histograms.clear();
+  transponders.clear();
+  started = NowMs();
+}
+
+void cScanStats::Add(const TTimes& Times) {
+  const std::lock_guard<std::mutex> lock(m);
+
+  if (Times.Empty())
+     return;
+  transponders.push_back(Times);
+
+  for(auto& s:Times.samples)
+     Sample(s.first, s.second);
+}
+
+void cScanStats::Add(const std::string& Name, int Ms) {
+  const std::lock_guard<std::mutex> lock(m);
+
+  if (Ms >= 0)
+     Sample(Name, Ms);
+}
+
+void cScanStats::Sample(const std::string& Name, int Ms) {
+  auto h = histograms.begin();
+  while(h != histograms.end() and h->name != Name)
+     ++h;
+  if (h == histograms.end())
+     h = histograms.insert(h, THistogram(Name));
+  h->Add(Ms);
+}
+
+std::vector<THistogram> cScanStats::Histograms(void) {
+  const std::lock_guard<std::mutex> lock(m);
+  return histograms;
+}
+
+/* one line per name: count, total, average, max and the histogram buckets.
+ * PerTransponder: one line per transponder instead, slowest first.
+ */
+std::string cScanStats::Report(bool PerTransponder) {
+  const std::lock_guard<std::mutex> lock(m);
+  std::stringstream ss;
+
+  ss << "scan time: " << (NowMs() - started) / 1000 << "s, "
+     << transponders.size() << " transponders";
+
+  if (PerTransponder) {
+     std::vector<const TTimes*> sorted;
+     for(auto& t:transponders)
+        sorted.push_back(&t);
+     std::stable_sort(sorted.begin(), sorted.end(), [](const TTimes* a, const TTimes* b) {
+        return a->elapsed > b->elapsed;
+        });
+
+     for(auto t:sorted) {
+        ss << '\n' << t->transponder << ": total=" << t->elapsed;
+        for(auto& i:t->times) {
+           ss << ' ' << i.first << '=' << i.second.total;
+           if (i.second.count > 1)
+              ss << '/' << i.second.count;
+           }
+        }
+     return ss.str();
+     }
+
+  ss << "\nname            count   total(ms) avg(ms) max(ms)  histogram(ms):";
+  for(int i = 0; i < THistogram::Buckets - 1; i++)
+     ss << " <=" << THistogram::Limits[i];
+  ss << " >" << THistogram::Limits[THistogram::Buckets - 2];
+
+  for(auto& h:histograms) {
+     ss << '\n' << h.name << std::string(h.name.size() < 14 ? 14 - h.name.size() : 0, ' ')
+        << FrontFill(IntToStr(h.count), 7)
+        << FrontFill(IntToStr(h.total), 12)
+        << FrontFill(IntToStr(h.count ? h.total / h.count : 0), 8)
+        << FrontFill(IntToStr(h.max), 8) << "  ";
+     for(int i = 0; i < THistogram::Buckets; i++)
+        ss << ' ' << h.buckets[i];
+     }
+  return ss.str();
+}
@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint> // uint{8,16,32,64}_t
+
+
+/*******************************************************************************
+ * timing of a scan, all times in msec of a monotonic clock.
+ * Names are state machine states ("Tune", "PAT", ..), "Lock" for the lock
+ * wait, "<table> filter" for the lifetime of section filters, "Probe" and
+ * "Scan lock" for the waits of the scanner before the state machine starts
+ * and "Add to VDR" for adding the channels at the end of a scan.
+ ******************************************************************************/
+uint64_t NowMs(void);
+
+// times of one transponder: sum and count per name.
+class TTimes {
+public:
+  struct TTime {
+     uint32_t count;
+     uint32_t total;
+     uint32_t max;
+     };
+  std::string transponder;
+  uint32_t elapsed;                                 // msec from tuning until the next transponder
+  std::vector<std::pair<std::string,TTime>> times;  // in order of first use
+  std::vector<std::pair<std::string,int>> samples;  // all single values, for the histograms
+  TTimes(void) : elapsed(0) {}
+  void Add(const std::string& Name, int Ms);
+  bool Empty(void) const { return samples.empty(); };
+  void Clear(void);
+};
+
+/* histogram per name over all transponders of a scan.
+ * bucket i counts samples up to Limits[i] msec, the last one all above.
+ */
+class THistogram {
+public:
+  static const int Buckets = 12;
+  static const uint32_t Limits[Buckets - 1];
+  std::string name;
+  uint32_t count;
+  uint64_t total;
+  uint32_t max;
+  uint32_t buckets[Buckets];
+  THistogram(const std::string& Name);
+  void Add(int Ms);
+};
+
+
+/*******************************************************************************
+ * class cScanStats
+ * collects the times of all state machines of the current (or last) scan.
+ ******************************************************************************/
+class cScanStats {
+private:
+  std::mutex m;
+  std::vector<THistogram> histograms;
+  std::vector<TTimes> transponders;
+  uint64_t started;
+  void Sample(const std::string& Name, int Ms);  // m has to be locked by caller.
+public:
+  cScanStats(void);
+  void Clear(void);
+  void Add(const TTimes& Times);
+  void Add(const std::string& Name, int Ms);     // not of a single transponder, histogram only.
+  std::vector<THistogram> Histograms(void);
+  std::string Report(bool PerTransponder);
+};
+
+extern cScanStats ScanStats;
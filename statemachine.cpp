@@ -5,7 +5,10 @@
 
 #include <string>
 #include <algorithm>      // std::min()
+#include <mutex>          // std::mutex
+#include <map>
 #include <vdr/receiver.h>
+#include <vdr/sources.h>
 #include "tlist.h"
 #include "scanner.h"
 #include "statemachine.h"
@@ -13,10 +16,10 @@
 #include "common.h"
 #include "menusetup.h"
 #include "si_ext.h"
+#include "arena.h"
 
 
-extern TChannels NewChannels;
-extern TChannels NewTransponders;
+extern cChannelList NewChannels;
 extern TChannels ScannedTransponders;
 
 
@@ -62,7 +65,8 @@ void cScanReceiver::Activate(bool On) {
 
 cStateMachine::cStateMachine(cDevice* Dev, TChannel* InitialTransponder, bool UseNit, void* Parent) :
   state(eStart), lastState(eStop), initial(InitialTransponder), dev(Dev),
-  dvbdevice(nullptr), stop(false), useNit(UseNit), parent(Parent)
+  dvbdevice(nullptr), stop(false), useNit(UseNit), parent(Parent), finished(false),
+  stateStart(0), tpStart(0)
 { 
   Start();
 }
@@ -75,6 +79,14 @@ cStateMachine::~cStateMachine(void) {
 
 void cStateMachine::DoStop(void) {
   stop = true;
+  event.Signal();
+}
+
+
+// blocks until Action() is left.
+void cStateMachine::Wait(void) {
+  while(!finished)
+     done.Wait(1000);
 }
 
 
@@ -83,7 +95,7 @@ bool cStateMachine::Active(void) {
 }
 
 
-// store state in lastState if modified and report new state
+// store state in lastState if modified, account the time spent there and report new state
 void cStateMachine::Report(eState State) {
   const char* stateMsg[] = { // be careful here: same order as eState
      "------- Start -------",
@@ -101,18 +113,79 @@ void cStateMachine::Report(eState State) {
      "------- GetTables -------",
      "------- NULL -------"
      };
+  const char* stateName[] = { // same order as eState
+     "Start", "Stop", "Tune", "NextTransponder", "DetachReceiver", "PAT", "PMT", "NIT",
+     "SDT", "EIT", "Unknown", "AddChannels", "GetTables", "NULL"
+     };
 
-  if ((State != lastState) and (wSetup.verbosity > 4))
-     dlog(5, stateMsg[lastState = State]);
+  if (State == lastState)
+     return;
+
+  uint64_t now = NowMs();
+  if (stateStart)
+     times.Add(stateName[lastState], now - stateStart);
+  stateStart = now;
+
+  // everything from tuning until the next transponder belongs to this one.
+  if (State == eTune)
+     Submit();
+
+  if (wSetup.verbosity > 4)
+     dlog(5, stateMsg[State]);
+  lastState = State;
 };
 
 
-TSdtData SdtData;
-TNitData NitData;
+// hand over the times of the current transponder to the scans statistics.
+void cStateMachine::Submit(void) {
+  uint64_t now = NowMs();
+
+  if (!times.transponder.empty()) {
+     times.elapsed = now - tpStart;
+     ScanStats.Add(times);
+     }
+  times.Clear();
+  tpStart = now;
+}
+
+
+// lifetime of a section filter, if it was started.
+static void AddFilterTime(TTimes& Times, const char* Name, cSectionFilter* Filter) {
+  if (Filter)
+     Times.Add(Name, Filter->Lifetime());
+}
+
+
+// results of several state machines, one per device, are merged one by one.
+std::mutex ResultsMutex;
+
+/* number of PMT filters run in parallel, learned per device: reduced if
+ * OpenFilter() fails or sections are lost, increased if all were in use
+ * without problems. SAT>IP devices start lower.
+ */
+static std::map<int,int> PmtFilterLimits;
+static std::mutex PmtFilterMutex;
+static const int MinPmtFilters = 1;
+static const int MaxPmtFilters = 64;
+
+static int GetPmtFilters(cDevice* Device) {
+  const std::lock_guard<std::mutex> lock(PmtFilterMutex);
+  auto it = PmtFilterLimits.find(Device->CardIndex());
+
+  if (it != PmtFilterLimits.end())
+     return it->second;
+  return GetDvbDevice(Device) ? 32 : 8;
+}
+
+static void SetPmtFilters(cDevice* Device, int Limit) {
+  const std::lock_guard<std::mutex> lock(PmtFilterMutex);
+  PmtFilterLimits[Device->CardIndex()] = constrain(Limit, MinPmtFilters, MaxPmtFilters);
+}
 
 // v 0.0.5, StateMachine itself
 void cStateMachine::Action(void) {
   TChannel* Transponder = nullptr;
+  TChannel* scanned = nullptr;
   cScanReceiver* aReceiver = nullptr;
   cPatScanner* PatScanner = nullptr;
   cNitScanner* NitScanner = nullptr;
@@ -120,18 +193,28 @@ void cStateMachine::Action(void) {
   eState newState = state;
   cScanner* scanner = (cScanner*)parent;
   int dvbtype = scanner->DvbType();
-  dvbdevice = scanner->DvbDevice();
+  dvbdevice = GetDvbDevice(dev);
+  cSectionReader* reader = new cSectionReader(dev);
   std::string s;
+  time_t tm = 0;
 
-  TList<cPmtScanner*> PmtScanners;
+  TList<cPmtScanner*,TListNoLock> PmtScanners;    // used by this thread only
   struct TPatData PatData;
-  TList<TPmtData*> PmtData;
+  TList<TPmtData*,TListNoLock> PmtData;
+  TArena pmtArena;                                // PMT scanners, until all PMTs are done
+  TArena tpArena;                                 // PMT data and channel candidates of a transponder
+  struct TSdtData SdtData;
+  struct TNitData NitData;
 
   bool pmtstart = false;
+  int nextPmt = 0;
+  int pmtLimit = 0, pmtPeak = 0, pmtOverflows = 0;
+  bool pmtFailed = false;
   bool tblstart = false;
 
   while (Running() && !stop) {
-     mSleep(10);
+     if (!scanner->ActionAllowed())
+        stop = true;
 
      Report(state);
 
@@ -153,6 +236,7 @@ void cStateMachine::Action(void) {
            Transponder->PrintTransponder(s);
            dlog(4, "tuning to " + s);
            lTransponder = s;
+           times.transponder = s;
 
            if (MenuScanning)
               MenuScanning->SetTransponder(Transponder);
@@ -163,29 +247,22 @@ void cStateMachine::Action(void) {
 
            cChannel c;
 
-           // skip ChannelID check in cChannel::Parse()
            // we just want to tune here, nothing else.
-           int nid = Transponder->NID;
-           int sid = Transponder->SID;
-           Transponder->NID = 0x2000;
-           Transponder->SID = 0x2000;
-
-           Transponder->VdrChannel(c);
+           Transponder->VdrTransponder(c);
            dev->SwitchChannel(&c, false);
 
-           Transponder->NID = nid;
-           Transponder->SID = sid;
-
            aReceiver = new cScanReceiver();
            dev->AttachReceiver(aReceiver);
 
            TChannel* tp = new TChannel;
            tp->CopyTransponderData(Transponder);
-           tp->Tested = true;
            tp->PrintTransponder(s);
 
-           mSleep(wSetup.SignalWaitTime * 1000);
-           if (dev->HasLock(wSetup.LockTimeout * 1000)) {
+           uint64_t lockStart = NowMs();
+           bool hasLock = WaitForLock(dev);
+           times.Add("Lock", NowMs() - lockStart);
+
+           if (hasLock) {
               dev->SetOccupied(90);
               dlog(4, "lock.");
               tp->Tunable = true;
@@ -195,11 +272,13 @@ void cStateMachine::Action(void) {
               dev->Detach(aReceiver);
               DeleteNullptr(aReceiver);
               tp->Tunable = false;
+              tp->Tested = true; // done, nothing to scan.
               newState = eNextTransponder;
               }
 
            dlog(4, "ScannedTransponders.Add: '" + s + "'");
            ScannedTransponders.Add(tp);
+           scanned = tp;
 
            lStrength = std::min((size_t)dev->SignalStrength(), (size_t)100);
 
@@ -214,17 +293,8 @@ void cStateMachine::Action(void) {
                goto DIRECT_EXIT;
 
            newState = eStop;
-           if (NewTransponders.Count()) {
-              Transponder = nullptr;
-              for(int i = 0; i < NewTransponders.Count(); i++) {
-                 if (NewTransponders[i]->Tested)
-                    continue;
-                 NewTransponders[i]->Tested = true;
-                 Transponder = NewTransponders[i];
-                 newState = eTune;
-                 break;
-                 }
-              }
+           if ((Transponder = NewTransponders.NextTransponder()) != nullptr)
+              newState = eTune;
 
            lProgress = 0.5 + (100.0 * (scanner->ThisChannel() + ScannedTransponders.Count()) / (NewTransponders.Count() + scanner->InitialTransponders()));
            if (MenuScanning) {
@@ -240,6 +310,10 @@ void cStateMachine::Action(void) {
               dev->SetOccupied(0);
               }
            DeleteNullptr(aReceiver);
+           AddFilterTime(times, "NIT filter", NitScanner);
+           AddFilterTime(times, "SDT filter", SdtScanner);
+           DeleteNullptr(NitScanner);
+           DeleteNullptr(SdtScanner);
 
            if (stop)
               newState = eStop;
@@ -249,12 +323,22 @@ void cStateMachine::Action(void) {
 
         case eScanPat:
            if (PatScanner == nullptr) {
-              PatScanner = new cPatScanner(dev, PatData);
-              mSleep(100);
+              PatScanner = new cPatScanner(reader, PatData, &event);
+
+              // SDT and NIT are read in parallel to PAT and PMTs, on their standard PIDs.
+              // A non-standard NIT PID is used after PAT only.
+              tm = time(0);
+              SdtData.original_network_id = 0;
+              NitData.OrbitalPos = initial->OrbitalPos;
+              NitData.West       = initial->West;
+              SdtScanner = new cSdtScanner(reader, SdtData, &event);
+              if (wSetup.DVBC_Network_PID == 0x10)
+                 NitScanner = new cNitScanner(reader, 0x10, NitData, dvbtype, &event);
               }
            else if (!PatScanner->Active()) {
               pmtstart = true;
               bool hasPAT = PatScanner->HasPAT();
+              AddFilterTime(times, "PAT filter", PatScanner);
               DeleteNullptr(PatScanner);
               if (stop or !hasPAT or !PatData.services.Count())
                  newState = eDetachReceiver;
@@ -262,50 +346,76 @@ void cStateMachine::Action(void) {
                  dlog(4, "searching " + IntToStr(PatData.services.Count()) + " services");
                  newState = eScanPmt;
                  }
-              break;
               }
+           else
+              event.Wait(1000);
            break;
 
         case eScanPmt:
            if (pmtstart) {
               pmtstart = false;
+              nextPmt = 0;
+              pmtLimit = GetPmtFilters(dev);
+              pmtPeak = 0;
+              pmtOverflows = reader->Overflows();
+              pmtFailed = false;
               PmtScanners.Clear();
               PmtData.Clear();
               for(int i = 0; i < PatData.services.Count(); i++) {
-                 TPmtData* d = new TPmtData;
+                 TPmtData* d = tpArena.New<TPmtData>();
                  d->program_map_PID = PatData.services[i].program_map_PID;
                  PmtData.Add(d);
-                 cPmtScanner* p = new cPmtScanner(dev, PmtData[i]);
+                 cPmtScanner* p = pmtArena.New<cPmtScanner>(reader, PmtData[i], &event);
                  PmtScanners.Add(p);
                  }
               }
            else {
-              // run up to 16 filters in parallel; up to 32 should be safe.
-              int activePmts = 0;
+              // run up to pmtLimit filters in parallel.
+              // they are started in order, all before nextPmt are running or finished.
               int finished = 0;
-              for(int i = 0; i < PmtScanners.Count() and !stop; i++) {
-                 cPmtScanner* p = (cPmtScanner*) PmtScanners[i];
-                 if (p->Finished()) {
+              for(int i = 0; i < nextPmt; i++)
+                 if (PmtScanners[i]->Finished())
                     finished++;
+
+              while(!stop and nextPmt < PmtScanners.Count() and nextPmt - finished < pmtLimit) {
+                 if (PmtScanners[nextPmt]->TryStart()) {
+                    nextPmt++;
                     continue;
                     }
-                 if (p->Active()) {
-                    if (++activePmts > 16)
-                       break;
-                    }
-                 else {
-                    p->Start();
-                    if (++activePmts > 16)
+                 pmtFailed = true;
+                 if (nextPmt == finished) {
+                    // not even one: try again, as soon as the SDT or NIT filter is done and frees its slot.
+                    if ((SdtScanner and SdtScanner->Active()) or (NitScanner and NitScanner->Active()))
                        break;
+                    // nothing left to free one: let it time out.
+                    PmtScanners[nextPmt++]->Start();
+                    break;
                     }
+                 // demux is full: try again, if one of them is done.
+                 pmtLimit = nextPmt - finished;
+                 SetPmtFilters(dev, pmtLimit);
+                 dlog(4, "device " + IntToStr(dev->CardIndex()) + ": PMT filters limited to " + IntToStr(pmtLimit));
+                 break;
                  }
+              pmtPeak = std::max(pmtPeak, nextPmt - finished);
 
-              if (finished < PmtScanners.Count())
+              if (finished < PmtScanners.Count()) {
+                 event.Wait(1000);
                  break;
+                 }
+
+              if (reader->Overflows() > pmtOverflows) {
+                 SetPmtFilters(dev, pmtLimit * 3 / 4);
+                 dlog(4, "device " + IntToStr(dev->CardIndex()) + ": sections lost, PMT filters reduced to " +
+                         IntToStr(GetPmtFilters(dev)));
+                 }
+              else if (!pmtFailed and pmtPeak >= pmtLimit and pmtLimit < MaxPmtFilters)
+                 SetPmtFilters(dev, pmtLimit + 4);
 
               for(int i=0; i<PmtScanners.Count(); i++)
-                 DeleteNullptr(PmtScanners[i]);
+                 AddFilterTime(times, "PMT filter", PmtScanners[i]);
               PmtScanners.Clear();
+              pmtArena.Clear();
 
               tblstart = true;
               if (stop)
@@ -316,21 +426,37 @@ void cStateMachine::Action(void) {
            break;
 
         case eGetTables: {
-           static int tm;
            if (tblstart) {
               tblstart = false;
-              tm = time(0);
               // some stupid cable providers use non-standard PID for NIT; sometimes called 'Setup-PID'.
               if (wSetup.DVBC_Network_PID != 0x10)
                  PatData.network_PID = wSetup.DVBC_Network_PID;
-              SdtData.original_network_id = 0;
-              NitData.OrbitalPos = initial->OrbitalPos;
-              NitData.West       = initial->West;
-              NitScanner = new cNitScanner(dev, PatData.network_PID, NitData, dvbtype);
-              SdtScanner = new cSdtScanner(dev, SdtData);
+              else if (PatData.network_PID and PatData.network_PID != 0x10 and
+                       NitScanner and !NitScanner->HasNIT()) {
+                 // PAT announces NIT on another PID.
+                 AddFilterTime(times, "NIT filter", NitScanner);
+                 DeleteNullptr(NitScanner);
+                 }
+              else
+                 PatData.network_PID = 0x10;
+              if (NitScanner == nullptr)
+                 NitScanner = new cNitScanner(reader, PatData.network_PID, NitData, dvbtype, &event);
+
+              // SDT other of a transponder scanned before may already have announced all services.
+              // The scanner has to be gone before merging, as it writes to SdtData.
+              if (SdtScanner->Active() and Transponder->ONID and
+                  HasSdtOther(Transponder->ONID, PatData.services[0].transport_stream_id)) {
+                 dlog(4, "services known from SDT other, skipping SDT.");
+                 AddFilterTime(times, "SDT filter", SdtScanner);
+                 DeleteNullptr(SdtScanner);
+                 GetSdtOther(Transponder->ONID, PatData.services[0].transport_stream_id, SdtData);
+                 }
               }
            else {
-              if (!NitScanner->Active() and !SdtScanner->Active()) {
+              // SDT other is read until here at most.
+              if (!NitScanner->Active() and (!SdtScanner or !SdtScanner->Active() or SdtScanner->HasSDT())) {
+                 AddFilterTime(times, "NIT filter", NitScanner);
+                 AddFilterTime(times, "SDT filter", SdtScanner);
                  DeleteNullptr(NitScanner);
                  DeleteNullptr(SdtScanner);
 
@@ -339,6 +465,8 @@ void cStateMachine::Action(void) {
                  else
                     newState = eAddChannels;
                  }
+              else
+                 event.Wait(1000);
               if (time(0) != tm) {
                  if (MenuScanning)
                     MenuScanning->SetProgress(lProgress);
@@ -349,6 +477,7 @@ void cStateMachine::Action(void) {
            break;
 
         case eAddChannels: {
+           const std::lock_guard<std::mutex> lock(ResultsMutex);
            if (wSetup.verbosity > 4) {
               for(int i = 0; i < PmtData.Count(); i++)
                  dlog(0, "PMT "                + IntToStr(PmtData[i]->program_map_PID) +
@@ -383,7 +512,7 @@ void cStateMachine::Action(void) {
                          ", ONID = " + IntToStr(NitData.transport_streams[i]->ONID) +
                          ", TID = "  + IntToStr(NitData.transport_streams[i]->TID));
 
-                 if (NitData.transport_streams[i]->Source == "T" and
+                 if (NitData.transport_streams[i]->Source == cSource::stTerr and
                      NitData.transport_streams[i]->DelSys == 1) {
                     for(int c=0; c<NitData.transport_streams[i]->cells.Count(); c++) {
                        for(int cf=0; cf<NitData.transport_streams[i]->cells[c].num_center_frequencies; cf++)
@@ -409,31 +538,41 @@ void cStateMachine::Action(void) {
            if (SdtData.original_network_id) // update onid, if sdt found. 
               Transponder->ONID = SdtData.original_network_id;
 
-           for(int i = 0; i < NitData.transport_streams.Count(); i++) {
-              if ((NitData.transport_streams[i]->NID == Transponder->NID or
-                  NitData.transport_streams[i]->ONID == Transponder->ONID) and
-                  NitData.transport_streams[i]->TID == Transponder->TID) {
+           for(auto ts:NitData.transport_streams.Snapshot()) {
+              if ((ts->NID == Transponder->NID or
+                  ts->ONID == Transponder->ONID) and
+                  ts->TID == Transponder->TID) {
                  uint32_t f = Transponder->Frequency;
-                 uint32_t center_freq = NitData.transport_streams[i]->Frequency;
+                 uint32_t center_freq = ts->Frequency;
 
-                 Transponder->CopyTransponderData(NitData.transport_streams[i]);
+                 Transponder->CopyTransponderData(ts);
 
                  if ((center_freq < 100000000) or (center_freq > 858000000) or (abs((int)center_freq - (int)f) > 2000000))
                     Transponder->Frequency = f;
+                 NewTransponders.Reindex(Transponder);
                  break;
                  }
               }
 
+           // keep the params learned here for the next scan.
+           if (scanned) {
+              scanned->CopyTransponderData(Transponder);
+              scanned->NID  = Transponder->NID;
+              scanned->ONID = Transponder->ONID;
+              scanned->TID  = Transponder->TID;
+              scanned->Tested = true; // done, checkpoints may skip it.
+              ScannedTransponders.Reindex(scanned);
+              }
+
+           // candidates live in tpArena, only the channels kept are moved to the heap.
            for(int i = 0; i < PmtData.Count(); i++) {
-              TChannel* n = new TChannel;
+              TChannel* n = tpArena.New<TChannel>();
               n->CopyTransponderData(Transponder);
               n->NID = Transponder->NID;
               n->ONID = Transponder->ONID;
               n->TID = Transponder->TID;
               n->SID = PmtData[i]->program_number;
-              n->VPID.PID  = PmtData[i]->Vpid.PID;
-              n->VPID.Type = PmtData[i]->Vpid.Type;
-              n->VPID.Lang = PmtData[i]->Vpid.Lang;
+              n->VPID  = PmtData[i]->Vpid;
               n->PCR   = PmtData[i]->PCR_PID;
               n->TPID  = PmtData[i]->Tpid;
               n->APIDs = PmtData[i]->Apids;
@@ -442,10 +581,8 @@ void cStateMachine::Action(void) {
               n->CAIDs = PmtData[i]->Caids;
               n->PMT = PmtData[i]->program_map_PID;
 
-              if (!n->VPID.PID and !n->APIDs.Count() and !n->DPIDs.Count()) {
-                 delete n;
+              if (!n->VPID.PID and !n->APIDs.Count() and !n->DPIDs.Count())
                  continue;
-                 }
 
               for(int j = 0; j < SdtData.services.Count(); j++) {
                  if (n->TID == SdtData.services[j].transport_stream_id and
@@ -520,78 +657,70 @@ void cStateMachine::Action(void) {
               else {
                  if (n->Name != "???") dlog(0, n->Name);
                  }
-              NewChannels.Add(n);
+              NewChannels.Add(new TChannel(std::move(*n)));
               if (MenuScanning)
                  MenuScanning->SetChan(NewChannels.Count()); 
               }
 
-           for(int i = 0; i < NewChannels.Count(); i++) {
-              if (NewChannels[i]->Name != "???")
-                 continue;
-              for(int j = 0; j < SdtData.services.Count(); j++) {
-                 if (NewChannels[i]->TID == SdtData.services[j].transport_stream_id and
-                   /*NewChannels[i]->NID == SdtData.services[j].original_network_id and*/
-                     NewChannels[i]->SID == SdtData.services[j].service_id) {
-                    NewChannels[i]->Name         = SdtData.services[j].Name;
-                    NewChannels[i]->Shortname    = SdtData.services[j].Shortname;
-                    NewChannels[i]->Provider     = SdtData.services[j].Provider;
-                    NewChannels[i]->free_CA_mode = SdtData.services[j].free_CA_mode;
-                    NewChannels[i]->Print(s);
-                    dlog(5, "Update: '" + s + "'");
-                    break;
-                    }
+           // channels without name, found before this SDT.
+           for(int j = 0; j < SdtData.services.Count(); j++) {
+              for(auto ch:NewChannels.GetByService(SdtData.services[j].transport_stream_id, SdtData.services[j].service_id)) {
+                 if (ch->Name != "???")
+                    continue;
+                 ch->Name         = SdtData.services[j].Name;
+                 ch->Shortname    = SdtData.services[j].Shortname;
+                 ch->Provider     = SdtData.services[j].Provider;
+                 ch->free_CA_mode = SdtData.services[j].free_CA_mode;
+                 ch->Print(s);
+                 dlog(5, "Update: '" + s + "'");
                  }
               }
 
-           for(int i = 0; i < NitData.transport_streams.Count(); i++) {
-              if (abs(NitData.transport_streams[i]->OrbitalPos - initial->OrbitalPos) > 5)
+           for(auto ts:NitData.transport_streams.Snapshot()) {
+              if (abs(ts->OrbitalPos - initial->OrbitalPos) > 5)
                  continue;
-              if (!known_transponder(NitData.transport_streams[i], true)) {
+              if (!known_transponder(ts, true)) {
                  TChannel* tp = new TChannel;
-                 tp->CopyTransponderData(NitData.transport_streams[i]);
-                 tp->NID = NitData.transport_streams[i]->NID;
-                 tp->ONID = NitData.transport_streams[i]->ONID;
-                 tp->TID = NitData.transport_streams[i]->TID;
+                 tp->CopyTransponderData(ts);
+                 tp->NID = ts->NID;
+                 tp->ONID = ts->ONID;
+                 tp->TID = ts->TID;
                  tp->PrintTransponder(s);
                  dlog(4, "NewTransponders.Add: '" + s + "'" +
                          ", NID = " + IntToStr(tp->NID) +
                          ", TID = " + IntToStr(tp->TID));
-                 NewTransponders.Add(tp);
+                 NewTransponders.Add(tp, tp->ONID == Transponder->ONID ? prioNitSameNetwork : prioNit);
                  }
 
-              if (NitData.transport_streams[i]->Source == "T" and NitData.transport_streams[i]->DelSys == 1) {
-                 for(int c = 0; c < NitData.transport_streams[i]->cells.Count(); c++) {
-                    for(int cf = 0; cf < NitData.transport_streams[i]->cells[c].num_center_frequencies; cf++) {
-                       TChannel* tp = new TChannel;
-                       tp->CopyTransponderData(NitData.transport_streams[i]);
-                       tp->NID = NitData.transport_streams[i]->NID;
-                       tp->TID = NitData.transport_streams[i]->TID;
-                       tp->Frequency = NitData.transport_streams[i]->cells[c].center_frequencies[cf];
+              if (ts->Source == cSource::stTerr and ts->DelSys == 1) {
+                 for(int c = 0; c < ts->cells.Count(); c++) {
+                    for(int cf = 0; cf < ts->cells[c].num_center_frequencies; cf++) {
+                       TChannel* tp = tpArena.New<TChannel>();
+                       tp->CopyTransponderData(ts);
+                       tp->NID = ts->NID;
+                       tp->TID = ts->TID;
+                       tp->Frequency = ts->cells[c].center_frequencies[cf];
                        if (!known_transponder(tp, true)) {
                           tp->PrintTransponder(s);
                           dlog(4, "NewTransponders.Add: '" + s + "'" +
                                   ", NID = " + IntToStr(tp->NID) +
                                   ", TID = " + IntToStr(tp->TID));
-                          NewTransponders.Add(tp);
+                          NewTransponders.Add(new TChannel(std::move(*tp)), prioCellCenter);
                           }
-                       else
-                          delete tp;
                        }
-                    for(int tf = 0; tf < NitData.transport_streams[i]->cells[c].num_transposers; tf++) {
-                       TChannel* tp = new TChannel;
-                       tp->CopyTransponderData(NitData.transport_streams[i]);
-                       tp->NID = NitData.transport_streams[i]->NID;
-                       tp->TID = NitData.transport_streams[i]->TID;
-                       tp->Frequency = NitData.transport_streams[i]->cells[c].transposers[tf].transposer_frequency;
+                    for(int tf = 0; tf < ts->cells[c].num_transposers; tf++) {
+                       TChannel* tp = tpArena.New<TChannel>();
+                       tp->CopyTransponderData(ts);
+                       tp->NID = ts->NID;
+                       tp->TID = ts->TID;
+                       tp->Frequency = ts->cells[c].transposers[tf].transposer_frequency;
                        if (!known_transponder(tp, true)) {
                           tp->PrintTransponder(s);
                           dlog(4, "NewTransponders.Add: '" + s + "'" +
                                   ", NID = " + IntToStr(tp->NID) +
                                   ", TID = " + IntToStr(tp->TID));
-                          NewTransponders.Add(tp);
+                          NewTransponders.Add(new TChannel(std::move(*tp)), prioTransposer);
                           }
-                       else
-                          delete tp;
                        }
                     }
                  }
@@ -604,7 +733,7 @@ void cStateMachine::Action(void) {
                  dlog(0, "NIT: cell_id "   + IntToStr  (NitData.cell_frequency_links[i].cell_id) +
                          ", frequency "    + FloatToStr(NitData.cell_frequency_links[i].frequency/1e6, 7, 3, false) +
                          "MHz network_id " + IntToStr  (NitData.cell_frequency_links[i].network_id));
-              t.Source       = 'T';
+              t.Source       = cSource::stTerr;
               t.Frequency    = NitData.cell_frequency_links[i].frequency;
               t.Bandwidth    = t.Frequency <= 226500000 ? 7 : 8;
               t.Inversion    = 999;
@@ -623,7 +752,7 @@ void cStateMachine::Action(void) {
                  dlog(4, "NewTransponders.Add: '" + s + "'" +
                          ", NID = " + IntToStr(n->NID) +
                          ", TID = " + IntToStr(n->TID));
-                 NewTransponders.Add(n);
+                 NewTransponders.Add(n, prioCellLink);
                  }
 
               t.DelSys = 1;
@@ -634,7 +763,7 @@ void cStateMachine::Action(void) {
                  dlog(4, "NewTransponders.Add: '" + s + "'" +
                          ", NID = " + IntToStr(n->NID) +
                          ", TID = " + IntToStr(n->TID));
-                 NewTransponders.Add(n);
+                 NewTransponders.Add(n, prioCellLink);
                  }
 
               for(int j = 0; j < NitData.cell_frequency_links[i].subcellcount; j++) {
@@ -654,7 +783,7 @@ void cStateMachine::Action(void) {
                     dlog(4, "NewTransponders.Add: '" + s + "'" +
                             ", NID = " + IntToStr(tp->NID) +
                             ", TID = " + IntToStr(tp->TID));
-                    NewTransponders.Add(tp);
+                    NewTransponders.Add(tp, prioCellLink);
                     }
                  
                  t.DelSys = 1;
@@ -665,35 +794,34 @@ void cStateMachine::Action(void) {
                     dlog(4, "NewTransponders.Add: '" + s + "'" +
                             ", NID = " + IntToStr(tp->NID) +
                             ", TID = " + IntToStr(tp->TID));
-                    NewTransponders.Add(tp);
+                    NewTransponders.Add(tp, prioCellLink);
                     }
                  }
               }
 
-           for(int i = 0; i < NewChannels.Count(); i++) {
-              if (NewChannels[i]->LCN == -1 and GetLCN(NewChannels[i]) and wSetup.verbosity > 4) {
+           NewChannels.ForEach([](TChannel* n) {
+              if (n->LCN == -1 and GetLCN(n) and wSetup.verbosity > 4) {
                  std::string s;
 
-                 s = "assigned LCN: " + FrontFill(IntToStr(NewChannels[i]->LCN),4);
+                 s = "assigned LCN: " + FrontFill(IntToStr(n->LCN),4);
 
-                 if (NewChannels[i]->LCN_minor > -1)
-                    s += "." + IntToStr(NewChannels[i]->LCN_minor);
+                 if (n->LCN_minor > -1)
+                    s += "." + IntToStr(n->LCN_minor);
 
                  s += " = (SID:ONID:TID) " +
-                    IntToStr(NewChannels[i]->SID ) + ":" +
-                    IntToStr(NewChannels[i]->ONID) + ":" +
-                    IntToStr(NewChannels[i]->TID );
+                    IntToStr(n->SID ) + ":" +
+                    IntToStr(n->ONID) + ":" +
+                    IntToStr(n->TID );
 
                  dlog(5, s);
                  }
-              }
+              });
 
            // delete data from current tp
            PatData.network_PID = 0x10;
            PatData.services.Clear();
-           for(int i=0; i<PmtData.Count(); i++)
-              delete PmtData[i];
            PmtData.Clear();
+           tpArena.Clear();
            NitData.frequency_list.Clear();
            NitData.cell_frequency_links.Clear();
 
@@ -710,5 +838,19 @@ void cStateMachine::Action(void) {
      }
   dlog(0, "DIRECT_EXIT");
   DIRECT_EXIT:
+  Submit();
+  DeleteNullptr(PatScanner);
+  PmtScanners.Clear();
+  pmtArena.Clear();
+  PmtData.Clear();
+  tpArena.Clear();
+  DeleteNullptr(NitScanner);
+  DeleteNullptr(SdtScanner);
+  DeleteNullptr(reader);
+  for(int i = 0; i < NitData.transport_streams.Count(); i++)
+     delete NitData.transport_streams[i];
+  NitData.transport_streams.Clear();
+  finished = true;
+  done.Signal();
   Cancel();
 }
@@ -3,7 +3,11 @@
  * See the README file for copyright information and how to reach the author.
  ******************************************************************************/
 #pragma once
+#include <mutex>
+#include <atomic>
 #include <repfunc.h>
+#include <vdr/thread.h>    // cCondWait
+#include "scanstats.h"     // TTimes
 
 /*******************************************************************************
  * forward decls
@@ -12,6 +16,9 @@ class cDevice;
 class cDvbDevice;
 class TChannel;
 
+// held while results of a transponder are added to the global lists.
+extern std::mutex ResultsMutex;
+
 
 /*******************************************************************************
  * class cStateMachine
@@ -41,6 +48,12 @@ private:
   bool        stop;
   bool        useNit;
   void*       parent;
+  cCondWait   event;              // signaled by filters when done, and by DoStop()
+  cCondWait   done;
+  std::atomic<bool> finished;
+  TTimes      times;              // of the current transponder
+  uint64_t    stateStart, tpStart;
+  void Submit(void);
 protected:
   virtual void Action(void);
   virtual void Report(eState State);
@@ -49,4 +62,5 @@ public:
   virtual ~cStateMachine(void);
   void DoStop(void);
   bool Active(void);
+  void Wait(void);
 };
@@ -0,0 +1,81 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <vdr/sources.h>
+#include "../menusetup.h"
+
+
+/*******************************************************************************
+ * the few VDR and plugin symbols the code under test references. Everything
+ * else is dropped by the linker (--gc-sections).
+ ******************************************************************************/
+
+cMenuScanning* MenuScanning = nullptr;
+
+void cMenuScanning::AddLogMsg(std::string Msg) {}
+
+cString::cString(const char* S, bool TakePointer) {
+  s = TakePointer ? (char*) S : S ? strdup(S) : nullptr;
+}
+
+cString::cString(const cString& String) : s(String.s ? strdup(String.s) : nullptr) {}
+
+cString::~cString() {
+  free(s);
+}
+
+cString& cString::operator=(const cString& String) {
+  if (this != &String) {
+     free(s);
+     s = String.s ? strdup(String.s) : nullptr;
+     }
+  return *this;
+}
+
+// as VDR's source.c
+cString cSource::ToString(int Code) {
+  char buffer[16];
+  char* q = buffer;
+  *q++ = (Code & st_Mask) >> 24;
+  if (int n = (Code & st_Pos)) {
+     if (n > 0x00007FFF)
+        n |= 0xFFFF0000;
+     q += snprintf(q, sizeof(buffer) - 2, "%u.%u", abs(n) / 10, abs(n) % 10);
+     *q++ = (n < 0) ? 'W' : 'E';
+     }
+  *q = 0;
+  return buffer;
+}
+
+int cSource::FromString(const char* s) {
+  if (s and *s and 'A' <= *s and *s <= 'Z') {
+     int code = int(*s) << 24;
+     if (code == stSat) {
+        int pos = 0;
+        bool dot = false;
+        bool neg = false;
+        while(*++s) {
+           if ('0' <= *s and *s <= '9')
+              pos = 10 * pos + *s - '0';
+           else if (*s == '.')
+              dot = true;
+           else if (*s == 'W' or *s == 'E') {
+              neg = *s == 'W';
+              if (!dot)
+                 pos *= 10;
+              }
+           else
+              return stNone;
+           }
+        if (neg)
+           pos = -pos;
+        code |= (pos & st_Pos);
+        }
+     return code;
+     }
+  return stNone;
+}
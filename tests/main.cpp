@@ -0,0 +1,23 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#include "test.h"
+
+int failures = 0;
+
+int main(void) {
+  TestTransponders();
+  TestSatellites();
+  TestCheckpoint();
+  TestAssembler();
+  TestChannels();
+  TestTList();
+  TestArena();
+
+  if (failures)
+     std::cerr << failures << " checks failed." << std::endl;
+  else
+     std::cout << "all tests passed." << std::endl;
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#pragma once
+#include <iostream>
+
+
+/*******************************************************************************
+ * standalone tests: CHECK() counts failures, main() returns their number.
+ ******************************************************************************/
+extern int failures;
+
+#define CHECK(x) do { if (!(x)) { \
+  std::cerr << __FILE__ << ':' << __LINE__ << ": failed: " << #x << std::endl; \
+  failures++; } } while(0)
+
+void TestTransponders(void);
+void TestSatellites(void);
+void TestCheckpoint(void);
+void TestAssembler(void);
+void TestChannels(void);
+void TestTList(void);
+void TestArena(void);
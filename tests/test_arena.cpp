@@ -0,0 +1,78 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "test.h"
+#include "../arena.h"
+
+
+/*******************************************************************************
+ * TArena
+ ******************************************************************************/
+
+// logs its destruction.
+struct TItem {
+  std::vector<int>& log;
+  int id;
+  std::string s;
+  TItem(std::vector<int>& Log, int Id) : log(Log), id(Id), s(100, 'x') {}
+  ~TItem() { log.push_back(id); }
+};
+
+struct alignas(64) TAligned {
+  char c;
+};
+
+struct TLarge {
+  char data[4096];
+};
+
+void TestArena(void) {
+  std::vector<int> log;
+  TArena arena(1024);
+
+  // destroyed all at once, in reverse order.
+  for(int i = 0; i < 20; i++) {
+     TItem* t = arena.New<TItem>(log, i);
+     CHECK(t->id == i and t->s.size() == 100);
+     }
+  CHECK(arena.Count() == 20);
+  CHECK(log.empty());
+  arena.Clear();
+  CHECK(arena.Count() == 0);
+  CHECK(log.size() == 20 and log.front() == 19 and log.back() == 0);
+
+  // alignment, within and across blocks.
+  for(int i = 0; i < 50; i++) {
+     arena.New<char>('a');
+     TAligned* a = arena.New<TAligned>();
+     CHECK(((uintptr_t) a % alignof(TAligned)) == 0);
+     double* d = arena.New<double>(1.5);
+     CHECK(((uintptr_t) d % alignof(double)) == 0 and *d == 1.5);
+     }
+
+  // bigger than a block.
+  TLarge* l = arena.New<TLarge>();
+  l->data[4095] = 1;
+  CHECK(arena.Count() == 151);
+  arena.Clear();
+
+  // blocks are reused, objects in them are new.
+  log.clear();
+  TItem* t = arena.New<TItem>(log, 42);
+  CHECK(t->id == 42);
+  arena.Clear();
+  CHECK(log.size() == 1 and log[0] == 42);
+
+  // the destructor clears.
+  log.clear();
+  {
+  TArena a;
+  a.New<TItem>(log, 1);
+  a.New<TItem>(log, 2);
+  }
+  CHECK((log == std::vector<int>{ 2, 1 }));
+}
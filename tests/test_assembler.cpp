@@ -0,0 +1,55 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#include "test.h"
+#include "../scanfilter.h"
+#include "../si_ext.h"
+
+
+/*******************************************************************************
+ * cTableAssembler
+ ******************************************************************************/
+
+void TestAssembler(void) {
+  cTableAssembler a;
+  const uint8_t sdt   = SI_EXT::TABLE_ID_SDT_ACTUAL;
+  const uint8_t other = SI_EXT::TABLE_ID_SDT_OTHER;
+
+  // a first section behind last_section_number leaves no table behind.
+  CHECK(not a.Sync(sdt, 1019, 3, 5, 2));
+  CHECK(not a.Complete(sdt));
+  CHECK(a.Sync(sdt, 1020, 0, 0, 0));
+  CHECK(a.Complete(sdt));
+  a.Reset();
+
+  // any order, duplicates ignored.
+  CHECK(not a.Complete(sdt));
+  CHECK(a.Sync(sdt, 1019, 3, 1, 2));
+  CHECK(not a.Sync(sdt, 1019, 3, 1, 2));
+  CHECK(a.Sync(sdt, 1019, 3, 0, 2));
+  CHECK(not a.Complete(sdt, 1019));
+  CHECK(a.Sync(sdt, 1019, 3, 2, 2));
+  CHECK(a.Complete(sdt, 1019));
+  CHECK(a.Complete(sdt));
+
+  // a new version starts over.
+  CHECK(a.Sync(sdt, 1019, 4, 0, 1));
+  CHECK(not a.Complete(sdt, 1019));
+  CHECK(not a.Complete(sdt));
+  CHECK(not a.Sync(sdt, 1019, 4, 2, 1));   // behind last_section_number
+
+  // SDT other: same TSID on two networks are different tables.
+  CHECK(a.Sync(other, 1101, 1, 0, 1, 1));
+  CHECK(a.Sync(other, 1101, 7, 1, 1, 133));
+  CHECK(not a.Complete(other, 1101, 1));
+  CHECK(not a.Complete(other, 1101, 133));
+  CHECK(a.Sync(other, 1101, 1, 1, 1, 1));
+  CHECK(a.Complete(other, 1101, 1));
+  CHECK(not a.Complete(other, 1101, 133));
+  CHECK(not a.Complete(other));
+  CHECK(a.Sync(other, 1101, 7, 0, 1, 0xFFFF) and not a.Complete(other, 1101, 133));
+
+  a.Reset();
+  CHECK(not a.Complete(other, 1101, 1));
+}
@@ -0,0 +1,190 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#include "test.h"
+#include "../common.h"
+
+
+/*******************************************************************************
+ * TChannels: frequency index per source.
+ ******************************************************************************/
+
+static TChannel* Transponder(const char* Source, int Frequency) {
+  TChannel* t = new TChannel;
+  t->Source    = cSource::FromString(Source);
+  t->Frequency = Frequency;
+  return t;
+}
+
+static void FrequencyIndex(void) {
+  TChannels list;
+  auto any = [](TChannel*) { return true; };
+
+  TChannel* a = Transponder("T", 474000);
+  TChannel* b = Transponder("T", 474166);             // offset +166kHz
+  TChannel* c = Transponder("T", 482000000);          // Hz
+  TChannel* d = Transponder("C", 474000);
+  TChannel* s = Transponder("S19.2E", 11494);
+  list.Add(a);
+  list.Add(b);
+  list.Add(c);
+  list.Add(d);
+  list.Add(s);
+
+  std::unique_ptr<TChannel> probe(Transponder("T", 474));  // MHz
+  CHECK(list.Find(probe.get(), 0, any) == a);
+  CHECK(list.Find(probe.get(), 200, [b](TChannel* t) { return t == b; }) == b);
+  CHECK(list.Find(probe.get(), 100, [b](TChannel* t) { return t == b; }) == nullptr);
+
+  probe->Frequency = 482000;
+  CHECK(list.Find(probe.get(), 0, any) == c);
+
+  // same frequency, other source.
+  probe->Source = cSource::FromString("C");
+  probe->Frequency = 474000;
+  CHECK(list.Find(probe.get(), 0, any) == d);
+  probe->Source = cSource::FromString("A");
+  CHECK(list.Find(probe.get(), 1000000, any) == nullptr);
+
+  // satellite: MHz.
+  probe->Source = cSource::FromString("S19.2E");
+  probe->Frequency = 11496;
+  CHECK(list.Find(probe.get(), 2, any) == s);
+  CHECK(list.Find(probe.get(), 1, any) == nullptr);
+
+  // changed frequency: found after Reindex() only at the new one.
+  probe->Source = cSource::FromString("T");
+  a->Frequency = 490000;
+  list.Reindex(a);
+  probe->Frequency = 474000;
+  CHECK(list.Find(probe.get(), 0, any) == nullptr);
+  probe->Frequency = 490000;
+  CHECK(list.Find(probe.get(), 0, any) == a);
+
+  // removed items are gone from the index.
+  list.Remove(a);
+  CHECK(list.Find(probe.get(), 0, any) == nullptr);
+  CHECK(list.IndexOf(c) == 1);
+  list.Delete(1);
+  probe->Frequency = 482000;
+  CHECK(list.Find(probe.get(), 0, any) == nullptr);
+  CHECK(list.Count() == 3);
+
+  // Assign() and AddList() index as well.
+  TChannels other, more;
+  more.Add(Transponder("T", 498000));
+  other.Assign(list);
+  other.AddList(more);
+  CHECK(other.Count() == 4);
+  probe->Frequency = 498000;
+  CHECK(other.Find(probe.get(), 0, any) == more[0]);
+  probe->Frequency = 474166;
+  CHECK(other.Find(probe.get(), 0, any) == b);
+  other.Remove(b);
+  CHECK(other.Find(probe.get(), 0, any) == nullptr);
+  other.Clear();
+  CHECK(other.Find(probe.get(), 1000000, any) == nullptr);
+
+  delete a;
+  delete c;
+  delete more[0];
+  for(int i = 0; i < list.Count(); i++)
+     delete list[i];
+  list.Clear();
+}
+
+
+/*******************************************************************************
+ * cChannelList: hashed by (ONID, TSID, SID) and by (TSID, SID).
+ ******************************************************************************/
+
+static TChannel* Service(const char* Source, int ONID, int TSID, int SID) {
+  TChannel* t = Transponder(Source, 474000);
+  t->ONID = ONID;
+  t->TID  = TSID;
+  t->SID  = SID;
+  return t;
+}
+
+static void ServiceIndex(void) {
+  cChannelList list;
+  int terr  = cSource::FromString("T");
+  int cable = cSource::FromString("C");
+
+  TChannel* a = Service("T", 8468, 769, 16385);
+  TChannel* b = Service("C", 8468, 769, 16385);        // same ids on cable
+  TChannel* c = Service("T", 1, 769, 16385);           // same service, other network
+  TChannel* d = Service("T", 8468, 769, 16386);
+  for(auto t:{ a, b, c, d })
+     list.Add(t);
+
+  CHECK(list.GetById(terr,  8468, 769, 16385) == a);
+  CHECK(list.GetById(cable, 8468, 769, 16385) == b);
+  CHECK(list.GetById(terr,  1,    769, 16385) == c);
+  CHECK(list.GetById(terr,  8468, 769, 16387) == nullptr);
+  CHECK(list.GetById(cable, 8468, 769, 16386) == nullptr);
+  CHECK(list.GetByService(769, 16385).size() == 3);
+  CHECK(list.GetByService(769, 16386).size() == 1);
+  CHECK(list.GetByService(770, 16385).empty());
+
+  list.Remove(a);
+  CHECK(list.GetById(terr, 8468, 769, 16385) == nullptr);
+  CHECK(list.GetByService(769, 16385).size() == 2);
+
+  list.Clear();
+  CHECK(list.GetById(cable, 8468, 769, 16385) == nullptr);
+  CHECK(list.GetByService(769, 16386).empty());
+
+  for(auto t:{ a, b, c, d })
+     delete t;
+}
+
+
+
+/*******************************************************************************
+ * TChannel: copies of PIDs and cells.
+ ******************************************************************************/
+
+static void Copies(void) {
+  TChannel a;
+  TPid p;
+
+  for(int i = 0; i < 6; i++) {
+     p.PID = 101 + i;
+     p.SetLang(i ? "deu" : "a language code list too long");
+     a.APIDs.Add(p);
+     }
+  CHECK(std::string(a.APIDs[0].Lang).size() == sizeof(p.Lang) - 1);
+  CHECK(a.cells.Count() == 0);
+
+  struct cell c;
+  memset(&c, 0, sizeof(c));
+  c.cell_id = 7;
+  a.cells.Add(c);
+
+  TChannel b;
+  b = a;
+  a.APIDs[5].PID = 0;
+  a.cells[0].cell_id = 8;
+  CHECK(b.APIDs.Count() == 6 and b.APIDs[5].PID == 106);
+  CHECK(std::string(b.APIDs[5].Lang) == "deu");
+  CHECK(b.cells.Count() == 1 and b.cells[0].cell_id == 7);
+
+  a.cells.Clear();
+  CHECK(b.cells.Count() == 1 and a.cells.Count() == 0);
+
+  // tuning only.
+  TChannel t;
+  a.Frequency = 11494;
+  a.StreamId  = 1 | 8 << 8 | 1 << 26;                   // multistream with PLS
+  t.CopyTransponderData(&a);
+  CHECK(t.Frequency == 11494 and t.StreamId == a.StreamId);
+  CHECK(t.APIDs.Count() == 0 and t.cells.Count() == 0);
+}
+
+void TestChannels(void) {
+  FrequencyIndex();
+  ServiceIndex();
+  Copies();
+}
@@ -0,0 +1,143 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#include <sstream>
+#include "test.h"
+#include "../transponders.h"
+#include "../satellites.h"
+
+
+/*******************************************************************************
+ * checkpoint: ReadCheckpoint(), WriteCheckpoint()
+ ******************************************************************************/
+
+static void ClearList(TChannels& List) {
+  for(int i = 0; i < List.Count(); i++)
+     delete List[i];
+  List.Clear();
+}
+
+static TChannel* Transponder(int Frequency, char Polarization) {
+  TChannel* t = new TChannel;
+  t->Source       = cSource::FromString("S19.2E");
+  t->Frequency    = Frequency;
+  t->Symbolrate   = 27500;
+  t->Polarization = Polarization;
+  t->OrbitalPos   = 192;
+  return t;
+}
+
+static void RoundTrip(void) {
+  TCheckpoint out, in;
+  TChannels jobs, channels, scanned, found;
+  TChannels inJobs, inScanned, inFound;
+  std::vector<std::string> texts;
+  std::vector<std::pair<int,int>> lcns;
+
+  out.Type         = 2;
+  out.CountryIndex = 3;
+  out.SatIndex     = txt_to_satellite("S19E2");
+  out.Satellites   = { txt_to_satellite("S13E0"), out.SatIndex, txt_to_satellite("S28E2") };
+  out.Satellite    = 1;
+
+  jobs.Add(Transponder(11494, 'H'));
+  jobs.Add(Transponder(11523, 'V'));
+  scanned.Add(Transponder(12188, 'H'));
+  found.Add(Transponder(10743, 'H'));
+
+  TChannel* c = Transponder(11494, 'H');
+  c->Name      = "Das Erste HD";
+  c->Provider  = "ARD";
+  c->SID       = 10301;
+  c->ONID      = 1;
+  c->TID       = 1019;
+  c->LCN       = 1;
+  c->LCN_minor = -1;
+  channels.Add(c);
+
+  std::stringstream ss;
+  WriteCheckpoint(ss, out, jobs, channels, scanned, found);
+
+  auto channel = [&texts,&lcns](int LCN, int LCN_minor, std::string Text) -> bool {
+     lcns.push_back(std::make_pair(LCN, LCN_minor));
+     texts.push_back(Text);
+     return true;
+     };
+  CHECK(ReadCheckpoint(ss, in, &inJobs, channel, &inScanned, &inFound, "test"));
+
+  CHECK(in.Type         == out.Type);
+  CHECK(in.CountryIndex == out.CountryIndex);
+  CHECK(in.SatIndex     == out.SatIndex);
+  CHECK(in.Satellite    == out.Satellite);
+  CHECK(in.Satellites   == out.Satellites);
+
+  CHECK(inJobs.Count() == 2 and inScanned.Count() == 1 and inFound.Count() == 1);
+  if (inJobs.Count() == 2) {
+     CHECK(inJobs[0]->Frequency == 11494 and inJobs[0]->Polarization == 'H' and not inJobs[0]->Tested);
+     CHECK(inJobs[1]->Frequency == 11523 and inJobs[1]->Polarization == 'V');
+     }
+  if (inScanned.Count() == 1)
+     CHECK(inScanned[0]->Frequency == 12188 and inScanned[0]->Tested);
+  if (inFound.Count() == 1)
+     CHECK(inFound[0]->Frequency == 10743 and not inFound[0]->Tested);
+
+  std::string text;
+  c->Print(text);
+  CHECK(texts.size() == 1);
+  if (texts.size() == 1) {
+     CHECK(texts[0] == text);
+     CHECK(lcns[0] == std::make_pair(1, -1));
+     }
+
+  // header only.
+  ss.clear();
+  ss.seekg(0);
+  texts.clear();
+  CHECK(ReadCheckpoint(ss, in, nullptr, nullptr, nullptr, nullptr, "test"));
+  CHECK(in.Satellites == out.Satellites);
+  CHECK(texts.empty());
+
+  for(auto l:{ &jobs, &channels, &scanned, &found, &inJobs, &inScanned, &inFound })
+     ClearList(*l);
+}
+
+static bool Header(std::string Line, TCheckpoint& Header) {
+  std::stringstream ss(Line + "\n");
+  return ReadCheckpoint(ss, Header, nullptr, nullptr, nullptr, nullptr, "test");
+}
+
+static void InvalidHeaders(void) {
+  TCheckpoint h;
+  int s = txt_to_satellite("S19E2");
+  std::string sat = std::to_string(s);
+
+  CHECK(Header("H:2:0:" + sat + ":0:", h));
+  CHECK(h.Satellite == 0 and h.Satellites.empty());
+  CHECK(Header("H:2:0:" + sat + ":1:" + sat + "," + sat, h));
+  CHECK(h.Satellite == 1 and h.Satellites.size() == 2);
+
+  CHECK(not Header("H:2:0:" + sat + ":1:", h));                       // no satellites
+  CHECK(not Header("H:2:0:" + sat + ":2:" + sat + "," + sat, h));     // behind the last one
+  CHECK(not Header("H:2:0:" + sat + ":-1:" + sat, h));
+  CHECK(not Header("H:2:0:" + sat + ":0:" + sat + ",99999", h));      // unknown satellite
+  CHECK(not Header("H:2:0:" + sat + ":0:" + sat + ",x", h));
+  CHECK(not Header("H:2:0:99999:0:", h));
+  CHECK(not Header("H:2:-1:" + sat + ":0:", h));
+  CHECK(not Header("H:2:0:" + sat + ":0", h));                        // field missing
+  CHECK(not Header("", h));
+
+  // nothing is read after an invalid header.
+  TChannels jobs;
+  std::stringstream ss;
+  ss << "H:2:0:" << sat << ":5:" << std::endl
+     << "J:S19.2E:11494:27500:8:999:999:999:H:999:2:999:999:0:0:0:999:999:999:192:0:0:0:0:0" << std::endl;
+  CHECK(not ReadCheckpoint(ss, h, &jobs, nullptr, nullptr, nullptr, "test"));
+  CHECK(jobs.Count() == 0);
+  ClearList(jobs);
+}
+
+void TestCheckpoint(void) {
+  RoundTrip();
+  InvalidHeaders();
+}
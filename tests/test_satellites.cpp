@@ -0,0 +1,46 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#include "test.h"
+#include "../satellites.h"
+
+
+/*******************************************************************************
+ * sort_by_rotor_position()
+ ******************************************************************************/
+
+void TestSatellites(void) {
+  int s13 = txt_to_satellite("S13E0");
+  int s19 = txt_to_satellite("S19E2");
+  int s23 = txt_to_satellite("S23E5");
+  int s28 = txt_to_satellite("S28E2");
+  CHECK(s13 >= 0 and s19 >= 0 and s23 >= 0 and s28 >= 0);
+
+  // no rotor positions: orbital, starting near the current one.
+  std::vector<int> sats = { s13, s28, s19 };
+  sort_by_rotor_position(sats, s28);
+  CHECK((sats == std::vector<int>{ s28, s19, s13 }));
+
+  sort_by_rotor_position(sats, s13);
+  CHECK((sats == std::vector<int>{ s13, s19, s28 }));
+
+  // rotor positions for some only: orbital.
+  sort_by_rotor_position(sats, s28, { { s13, 5 }, { s19, 1 } });
+  CHECK((sats == std::vector<int>{ s28, s19, s13 }));
+
+  // rotor positions for all selected, current one unknown:
+  // start at the selected one nearest in orbit, S19E2.
+  std::map<int,int> rotor = { { s13, 5 }, { s19, 1 }, { s28, 2 } };
+  sort_by_rotor_position(sats, s23, rotor);
+  CHECK((sats == std::vector<int>{ s19, s28, s13 }));
+
+  // no current satellite: start at the first selected.
+  sats = { s13, s28, s19 };
+  sort_by_rotor_position(sats, -1, rotor);
+  CHECK((sats == std::vector<int>{ s13, s28, s19 }));
+
+  sats = { s19 };
+  sort_by_rotor_position(sats, s13, rotor);
+  CHECK((sats == std::vector<int>{ s19 }));
+}
@@ -0,0 +1,110 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#include <thread>
+#include <vector>
+#include "test.h"
+#include "../tlist.h"
+
+
+/*******************************************************************************
+ * TList, with each lock policy.
+ ******************************************************************************/
+
+template<class L> static void Basics(void) {
+  TList<int,L> list;
+
+  for(int i = 0; i < 5; i++)
+     list.Add(i);
+  CHECK(list.Count() == 5);
+  CHECK(list.First() == 0 and list.Last() == 4);
+  CHECK(list.IndexOf(3) == 3 and list.IndexOf(7) == -1);
+
+  // Move() locks once.
+  list.Move(0, 3);
+  CHECK((list.Snapshot() == std::vector<int>{ 1, 2, 0, 3, 4 }));
+  list.Move(4, 0);
+  CHECK((list.Snapshot() == std::vector<int>{ 4, 1, 2, 0, 3 }));
+
+  int sum = 0;
+  list.ForEach([&sum](int& i) { sum += i; i *= 2; });
+  CHECK(sum == 10);
+  CHECK((list.Snapshot() == std::vector<int>{ 8, 2, 4, 0, 6 }));
+
+  list.Sort();
+  CHECK((list.Snapshot() == std::vector<int>{ 0, 2, 4, 6, 8 }));
+  CHECK(list.Remove(4) == 2 and list.Count() == 4);
+  list.Delete(0);
+  list.Insert(1, 5);
+  CHECK((list.Snapshot() == std::vector<int>{ 2, 5, 6, 8 }));
+
+  TList<int,L> copy;
+  copy.Assign(list);
+  copy.AddList(list);
+  CHECK(copy.Count() == 8 and copy[4] == 2);
+  list.Clear();
+  CHECK(list.Count() == 0 and copy.Count() == 8);
+}
+
+// several writers and readers at once.
+template<class L> static void Threads(void) {
+  TList<int,L> list;
+  std::vector<std::thread> threads;
+  const int n = 10000;
+
+  for(int t = 0; t < 4; t++)
+     threads.push_back(std::thread([&list]() {
+        for(int i = 0; i < n; i++)
+           list.Add(i);
+        }));
+  threads.push_back(std::thread([&list]() {
+     for(int i = 0; i < n / 10; i++)
+        list.ForEach([](int&) {});
+     }));
+  for(auto& t:threads)
+     t.join();
+
+  CHECK(list.Count() == 4 * n);
+  long sum = 0;
+  for(auto i:list.Snapshot())
+     sum += i;
+  CHECK(sum == 4L * n * (n - 1) / 2);
+}
+
+
+
+/*******************************************************************************
+ * TSmallList: N items inline, more of them allocated.
+ ******************************************************************************/
+
+static void SmallList(void) {
+  TSmallList<int,4> list;
+
+  for(int i = 0; i < 10; i++)
+     list.Add(i * i);
+  CHECK(list.Count() == 10);
+  for(int i = 0; i < 10; i++)
+     CHECK(list[i] == i * i);
+  CHECK(list.IndexOf(9) == 3 and list.IndexOf(49) == 7 and list.IndexOf(2) == -1);
+
+  list[8] = -1;
+  const TSmallList<int,4>& c = list;
+  CHECK(c[8] == -1 and c.IndexOf(-1) == 8);
+
+  TSmallList<int,4> copy(list);
+  list.Clear();
+  CHECK(list.Count() == 0 and list.IndexOf(0) == -1);
+  CHECK(copy.Count() == 10 and copy[9] == 81);
+  list.Add(5);
+  CHECK(list.Count() == 1 and list[0] == 5);
+}
+
+void TestTList(void) {
+  Basics<TListNoLock>();
+  Basics<TListMutex>();
+  Basics<TListSharedMutex>();
+  Threads<TListMutex>();
+  Threads<TListSharedMutex>();
+  SmallList();
+}
@@ -0,0 +1,136 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#include <sstream>
+#include "test.h"
+#include "../transponders.h"
+
+
+/*******************************************************************************
+ * transponder DB: ReadTransponders(), WriteTransponders()
+ ******************************************************************************/
+
+static void ClearList(TChannels& List) {
+  for(int i = 0; i < List.Count(); i++)
+     delete List[i];
+  List.Clear();
+}
+
+static void RoundTrip(void) {
+  TChannels out, in;
+
+  TChannel* s = new TChannel;
+  s->Source       = cSource::FromString("S19.2E");
+  s->Frequency    = 11494;
+  s->Symbolrate   = 22000;
+  s->Polarization = 'H';
+  s->Modulation   = 5;
+  s->StreamId     = 1;
+  s->DelSys       = 1;
+  s->OrbitalPos   = 192;
+  s->ONID         = 1;
+  s->NID          = 1;
+  s->TID          = 1093;
+  s->Tunable      = true;
+  out.Add(s);
+
+  TChannel* w = new TChannel;
+  w->Source       = cSource::FromString("S30.0W");
+  w->Frequency    = 10804;
+  w->Symbolrate   = 27500;
+  w->Polarization = 'V';
+  w->OrbitalPos   = 300;
+  w->West         = true;
+  out.Add(w);
+
+  TChannel* t = new TChannel;
+  t->Source       = cSource::FromString("T");
+  t->Frequency    = 658000;
+  t->Bandwidth    = 8;
+  t->Modulation   = 64;
+  t->Guard        = 4;
+  t->Transmission = 8;
+  t->ONID         = 8468;
+  t->TID          = 769;
+  out.Add(t);
+
+  std::stringstream ss;
+  WriteTransponders(ss, out, "test");
+  CHECK(ss.str()[0] == '#');
+
+  CHECK(ReadTransponders(ss, in, "test") == 3);
+  CHECK(in.Count() == 3);
+
+  for(int i = 0; i < in.Count() and i < out.Count(); i++) {
+     TChannel* a = out[i];
+     TChannel* b = in[i];
+     CHECK(a->Source       == b->Source);
+     CHECK(a->Frequency    == b->Frequency);
+     CHECK(a->Symbolrate   == b->Symbolrate);
+     CHECK(a->Bandwidth    == b->Bandwidth);
+     CHECK(a->FEC          == b->FEC);
+     CHECK(a->FEC_low      == b->FEC_low);
+     CHECK(a->Guard        == b->Guard);
+     CHECK(a->Polarization == b->Polarization);
+     CHECK(a->Inversion    == b->Inversion);
+     CHECK(a->Modulation   == b->Modulation);
+     CHECK(a->Pilot        == b->Pilot);
+     CHECK(a->Rolloff      == b->Rolloff);
+     CHECK(a->StreamId     == b->StreamId);
+     CHECK(a->SystemId     == b->SystemId);
+     CHECK(a->DelSys       == b->DelSys);
+     CHECK(a->Transmission == b->Transmission);
+     CHECK(a->MISO         == b->MISO);
+     CHECK(a->Hierarchy    == b->Hierarchy);
+     CHECK(a->OrbitalPos   == b->OrbitalPos);
+     CHECK(a->West         == b->West);
+     CHECK(a->ONID         == b->ONID);
+     CHECK(a->NID          == b->NID);
+     CHECK(a->TID          == b->TID);
+     CHECK(a->Tunable      == b->Tunable);
+     }
+
+  // found again by frequency after reading.
+  CHECK(in.Find(t, 0, [](TChannel*) { return true; }) == in[2]);
+
+  ClearList(out);
+  ClearList(in);
+}
+
+static void InvalidLines(void) {
+  TChannels in;
+  std::stringstream ss;
+
+  ss << "# comment" << std::endl
+     << std::endl
+     << "T:474000:0:8:999:999:4:-:999:64:999:999:0:0:0:8:0:999:0:0:8468:8468:769:1"       << std::endl  // valid
+     << "T:482000:0:8:999:999:4:-:999:64:999:999:0:0:0:8:0:999:0:0:8468:8468:769"         << std::endl  // field missing
+     << "T:490000:0:8:999:999:4:-:999:64:999:999:0:0:0:8:0:999:0:0:8468:8468:769:1:0"     << std::endl  // field too much
+     << "T:498000:0:8:abc:999:4:-:999:64:999:999:0:0:0:8:0:999:0:0:8468:8468:769:1"       << std::endl  // not a number
+     << "T:99999999999:0:8:999:999:4:-:999:64:999:999:0:0:0:8:0:999:0:0:8468:8468:769:1"  << std::endl  // out of range
+     << "T:506000::8:999:999:4:-:999:64:999:999:0:0:0:8:0:999:0:0:8468:8468:769:1"        << std::endl  // empty number
+     << "garbage"                                                                          << std::endl
+     << "T:514000:0:8:999:999:4:-:999:64:999:999:0:0:0:8:0:999:0:0:8468:8468:770:0";                    // valid, no newline
+
+  CHECK(ReadTransponders(ss, in, "test") == 2);
+  CHECK(in.Count() == 2);
+  if (in.Count() == 2) {
+     CHECK(in[0]->Frequency == 474000);
+     CHECK(in[0]->Polarization == 0);
+     CHECK(in[0]->Tunable);
+     CHECK(in[1]->Frequency == 514000);
+     CHECK(in[1]->TID == 770);
+     CHECK(not in[1]->Tunable);
+     }
+  ClearList(in);
+
+  std::stringstream empty;
+  CHECK(ReadTransponders(empty, in, "test") == 0);
+  CHECK(in.Count() == 0);
+}
+
+void TestTransponders(void) {
+  RoundTrip();
+  InvalidLines();
+}
@@ -6,6 +6,9 @@
 #include <vector>
 #include <mutex>
 #include <algorithm>
+#if __cplusplus >= 201402L
+#include <shared_mutex>
+#endif
 
 
 /*******************************************************************************
@@ -16,78 +19,118 @@ typedef bool (*TListSortCompare)(void* Item1, void* Item2);
 
 
 /*******************************************************************************
- * class TList
+ * lock policies of TList:
+ *   TListNoLock       lists owned by one thread at a time, ie. members of a
+ *                     channel or of PMT data.
+ *   TListMutex        default, one std::mutex.
+ *   TListSharedMutex  lists read by several threads at once. Before C++14
+ *                     there is no shared mutex; it is a TListMutex then.
  ******************************************************************************/
 
-template<class T> class TList {
+class TListNoLock {
+public:
+  void lock(void) {}
+  void unlock(void) {}
+  void lock_shared(void) {}
+  void unlock_shared(void) {}
+};
+
+class TListMutex : public std::mutex {
+public:
+  void lock_shared(void) { lock(); }
+  void unlock_shared(void) { unlock(); }
+};
+
+#if __cplusplus >= 201703L
+typedef std::shared_mutex TListSharedMutex;
+#elif __cplusplus >= 201402L
+typedef std::shared_timed_mutex TListSharedMutex;
+#else
+typedef TListMutex TListSharedMutex;
+#endif
+
+// std::shared_lock is C++14.
+template<class L> class TListReadLock {
 private:
-  std::mutex m;
+  L& l;
+public:
+  TListReadLock(L& Lock) : l(Lock) { l.lock_shared(); }
+  ~TListReadLock() { l.unlock_shared(); }
+};
+
+
+/*******************************************************************************
+ * class TList
+ ******************************************************************************/
+
+template<class T, class L = TListMutex> class TList {
 protected:
+  L m;
   std::vector<T> v;
 public:
   TList(void) {}                                         // constructor
-  TList(const TList<T>& other) : v(other.v) {}           // non-swap copy constructor
+  TList(const TList& other) : v(other.v) {}              // non-swap copy constructor
   ~TList() { v.clear(); }
 
   void Add(T p) {                                        // Add a new item to the list.
-     const std::lock_guard<std::mutex> lock(m);
+     const std::lock_guard<L> lock(m);
      v.push_back(p);
      if (v.size() == v.capacity())
         v.reserve(v.capacity() << 1);
      }
 
   int Capacity(void) {                                   // returns max number of items
-     const std::lock_guard<std::mutex> lock(m);
+     const TListReadLock<L> lock(m);
      return v.capacity();
      }
 
   void Capacity(size_t newCap) {                         // sets max number of items
-     const std::lock_guard<std::mutex> lock(m);
+     const std::lock_guard<L> lock(m);
      v.reserve(newCap);
      }
 
   void Clear(void) {                                     // Clears the list.
-     const std::lock_guard<std::mutex> lock(m);
+     const std::lock_guard<L> lock(m);
      v.clear();
      }
 
   int Count(void) {                                      // Current number of items.
-     const std::lock_guard<std::mutex> lock(m);
+     const TListReadLock<L> lock(m);
      return v.size();
      }
 
   void Delete(size_t Index) {                            // Removes items from list.
-     const std::lock_guard<std::mutex> lock(m);
+     const std::lock_guard<L> lock(m);
      v.erase(v.begin()+Index);
      }
 
   void Exchange(size_t Index1, size_t Index2) {          // Exchanges two items
-     const std::lock_guard<std::mutex> lock(m);
+     const std::lock_guard<L> lock(m);
      T p1 = v[Index1];
      T p2 = v[Index2];
      v[Index1] = p2;
      v[Index2] = p1;
      }
 
-  TList<T> Expand(void) {                                // Increases the capacity of the list if needed.                 
-     const std::lock_guard<std::mutex> lock(m);
+  TList Expand(void) {                                // Increases the capacity of the list if needed.                 
+     const std::lock_guard<L> lock(m);
      if (v.size() == v.capacity())
         v.resize(v.capacity() << 1);
      return *this;
      }
 
   T First(void) {                                       // Returns the first non-nil pointer in the list.
-     const std::lock_guard<std::mutex> lock(m);
+     const TListReadLock<L> lock(m);
      return v.front();
      }
 
   T Last(void)  {                                       // Returns the last non-nil pointer in the list.
-     const std::lock_guard<std::mutex> lock(m);
+     const TListReadLock<L> lock(m);
      return v.back();
      }
 
   int IndexOf(T Item) {                                 // Returns the index of a given item.
-     const std::lock_guard<std::mutex> lock(m);
+     const TListReadLock<L> lock(m);
      for(size_t i=0; i<v.size(); i++) {
         if (v[i] == Item)
            return i;
@@ -96,7 +139,7 @@ public:
      }
 
   void Insert(size_t Index, T Item) {                   // Inserts a new pointer in the list at a given position.
-     const std::lock_guard<std::mutex> lock(m);
+     const std::lock_guard<L> lock(m);
      v.insert(v.begin() + Index , Item);
      }
 
@@ -104,36 +147,36 @@ public:
      if (CurIndex == NewIndex)
         return;
 
-     const std::lock_guard<std::mutex> lock(m);
-     T& item = v[CurIndex];
-     Delete(CurIndex);
+     const std::lock_guard<L> lock(m);
+     T item = v[CurIndex];
+     v.erase(v.begin() + CurIndex);
 
      if (CurIndex < NewIndex)
-        Insert(NewIndex-1, item);
+        v.insert(v.begin() + NewIndex - 1, item);
      else
-        Insert(NewIndex  , item);
+        v.insert(v.begin() + NewIndex    , item);
      }
 
   T& operator[](int const& Index) {                     // Provides access to Items (pointers) in the list.
-     const std::lock_guard<std::mutex> lock(m);
+     const TListReadLock<L> lock(m);
      return v[Index];
      }
 
-  TList<T>& operator=(const TList<T>& other) {          // copy assignment operator.
+  TList& operator=(const TList& other) {          // copy assignment operator.
      if (this != &other) {
-        const std::lock_guard<std::mutex> lock(m);
+        const std::lock_guard<L> lock(m);
         v = other.v;
         }
      return *this;
      }
 
   T& Items(size_t const& Index) {
-     const std::lock_guard<std::mutex> lock(m);
+     const TListReadLock<L> lock(m);
      return v[Index];
      }
 
   int Remove(T Item) {                                  // Removes a value from the list & returns it's index before removal
-     const std::lock_guard<std::mutex> lock(m);
+     const std::lock_guard<L> lock(m);
      for(size_t i=0; i<v.size(); i++) {
         if (v[i] == Item) {
            v.erase(v.begin()+i);
@@ -144,32 +187,93 @@ public:
      }
 
   void Sort(TListSortCompare Compare) {                 // Sorts the items in the list using a function.
-     const std::lock_guard<std::mutex> lock(m);
+     const std::lock_guard<L> lock(m);
      std::sort(v.begin(), v.end(), Compare);
      }
 
   void Sort(void) {                                     // Sorts the items in the list using operator '<'.
-     const std::lock_guard<std::mutex> lock(m);
+     const std::lock_guard<L> lock(m);
      std::sort(v.begin(), v.end());
      }
 
-  void Assign(TList<T>& from) {                         // Copy the contents of other lists.
-     const std::lock_guard<std::mutex> lock(m);
+  void Assign(TList& from) {                         // Copy the contents of other lists.
+     const std::lock_guard<L> lock(m);
      v.assign(from.v.begin(), from.v.end());
      }
 
-  void AddList(TList<T>& aList) {                       // Add all items from another list
-     const std::lock_guard<std::mutex> lock(m);
+  void AddList(TList& aList) {                       // Add all items from another list
+     const std::lock_guard<L> lock(m);
      v.insert(v.end(),aList.v.begin(),aList.v.end());
      }
 
   T* List(void) {                                       // Returns the items in an array.
-     const std::lock_guard<std::mutex> lock(m);
+     const TListReadLock<L> lock(m);
      return v.data();
      }
 
+  template<class F> void ForEach(F Function) {         // Calls Function(T&) for all items, locked once.
+     const std::lock_guard<L> lock(m);
+     for(auto& i:v)
+        Function(i);
+     }
+
+  std::vector<T> Snapshot(void) {                       // Returns a copy of all items, locked once.
+     const TListReadLock<L> lock(m);
+     return v;
+     }
+
   void Pack(void) {                                     // Removes nullptr's from the list and frees unused memory.
-     const std::lock_guard<std::mutex> lock(m);
+     const std::lock_guard<L> lock(m);
      v.shrink_to_fit();
      }
 };
+
+
+/*******************************************************************************
+ * class TSmallList
+ * a list of plain data items, ie. the PIDs of a channel. The first N items
+ * are stored inline, only more of them are allocated. Not locked, the owner
+ * of the list has to take care.
+ ******************************************************************************/
+
+template<class T, int N> class TSmallList {
+private:
+  int count;
+  T items[N];
+  std::vector<T> more;
+public:
+  TSmallList(void) : count(0) {}
+
+  void Add(const T& Item) {                             // Add a new item to the list.
+     if (count < N)
+        items[count] = Item;
+     else
+        more.push_back(Item);
+     count++;
+     }
+
+  void Clear(void) {                                    // Clears the list.
+     count = 0;
+     more.clear();
+     }
+
+  int Count(void) const {                               // Current number of items.
+     return count;
+     }
+
+  int IndexOf(const T& Item) const {                    // Returns the index of a given item.
+     for(int i = 0; i < count; i++) {
+        if ((*this)[i] == Item)
+           return i;
+        }
+     return -1;
+     }
+
+  T& operator[](int Index) {                            // Provides access to the items.
+     return Index < N ? items[Index] : more[Index - N];
+     }
+
+  const T& operator[](int Index) const {
+     return Index < N ? items[Index] : more[Index - N];
+     }
+};
@@ -0,0 +1,316 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#include <string>
+#include <fstream>
+#include <cstdio>           // rename(), remove()
+#include <algorithm>        // std::max()
+#include <vdr/plugin.h>     // cPlugin::ConfigDirectory()
+#include <vdr/channels.h>
+#include "transponders.h"
+#include "countries.h"      // COUNTRY::country_count()
+#include "satellites.h"     // sat_count()
+
+
+/* one transponder per line, all tuning parameters as plain numbers:
+ * Source:Frequency:Symbolrate:Bandwidth:FEC:FEC_low:Guard:Polarization:Inversion:
+ * Modulation:Pilot:Rolloff:StreamId:SystemId:DelSys:Transmission:MISO:Hierarchy:
+ * OrbitalPos:West:ONID:NID:TID:Tunable
+ */
+static const size_t fieldcount = 24;
+
+static std::string FileName(std::string Name) {
+  return std::string(cPlugin::ConfigDirectory("wirbelscan")) + "/transponders-" + Name + ".conf";
+}
+
+/* fieldcount items, starting at items[first]. throws on invalid numbers. */
+static TChannel* ParseTransponder(std::vector<std::string>& items, size_t first) {
+  TChannel* t = new TChannel;
+  size_t i = first;
+
+  try {
+     t->Source       = cSource::FromString(items[i++].c_str());
+     t->Frequency    = std::stoi(items[i++]);
+     t->Symbolrate   = std::stoi(items[i++]);
+     t->Bandwidth    = std::stoi(items[i++]);
+     t->FEC          = std::stoi(items[i++]);
+     t->FEC_low      = std::stoi(items[i++]);
+     t->Guard        = std::stoi(items[i++]);
+     t->Polarization = items[i++][0];
+     if (t->Polarization == '-')
+        t->Polarization = 0;
+     t->Inversion    = std::stoi(items[i++]);
+     t->Modulation   = std::stoi(items[i++]);
+     t->Pilot        = std::stoi(items[i++]);
+     t->Rolloff      = std::stoi(items[i++]);
+     t->StreamId     = std::stoi(items[i++]);
+     t->SystemId     = std::stoi(items[i++]);
+     t->DelSys       = std::stoi(items[i++]);
+     t->Transmission = std::stoi(items[i++]);
+     t->MISO         = std::stoi(items[i++]);
+     t->Hierarchy    = std::stoi(items[i++]);
+     t->OrbitalPos   = std::stoi(items[i++]);
+     t->West         = std::stoi(items[i++]) != 0;
+     t->ONID         = std::stoi(items[i++]);
+     t->NID          = std::stoi(items[i++]);
+     t->TID          = std::stoi(items[i++]);
+     t->Tunable      = std::stoi(items[i++]) != 0;
+     }
+  catch(...) {
+     delete t;
+     throw;
+     }
+  return t;
+}
+
+static void PrintTransponder(std::ostream& os, TChannel* t) {
+  os << t->SourceName()                     << ':'
+     << t->Frequency                        << ':'
+     << t->Symbolrate                       << ':'
+     << t->Bandwidth                        << ':'
+     << t->FEC                              << ':'
+     << t->FEC_low                          << ':'
+     << t->Guard                            << ':'
+     << (t->Polarization ? t->Polarization : '-') << ':'
+     << t->Inversion                        << ':'
+     << t->Modulation                       << ':'
+     << t->Pilot                            << ':'
+     << t->Rolloff                          << ':'
+     << t->StreamId                         << ':'
+     << t->SystemId                         << ':'
+     << t->DelSys                           << ':'
+     << t->Transmission                     << ':'
+     << t->MISO                             << ':'
+     << t->Hierarchy                        << ':'
+     << t->OrbitalPos                       << ':'
+     << (t->West ? 1 : 0)                   << ':'
+     << t->ONID                             << ':'
+     << t->NID                              << ':'
+     << t->TID                              << ':'
+     << (t->Tunable ? 1 : 0);
+}
+
+int ReadTransponders(std::istream& is, TChannels& List, std::string Where) {
+  std::string line;
+  int count = 0;
+
+  while(std::getline(is, line)) {
+     if (line.empty() or line[0] == '#')
+        continue;
+
+     auto items = SplitStr(line, ':');
+     if (items.size() != fieldcount) {
+        dlog(0, Where + ": invalid line '" + line + "'");
+        continue;
+        }
+
+     try {
+        List.Add(ParseTransponder(items, 0));
+        count++;
+        }
+     catch(...) {
+        dlog(0, Where + ": invalid line '" + line + "'");
+        }
+     }
+  return count;
+}
+
+void WriteTransponders(std::ostream& os, TChannels& List, std::string Name) {
+  os << "# wirbelscan: transponders found on " << Name << ", do not edit." << std::endl;
+  for(int idx = 0; idx < List.Count(); idx++) {
+     PrintTransponder(os, List[idx]);
+     os << std::endl;
+     }
+}
+
+bool LoadTransponders(std::string Name, TChannels& List) {
+  std::string file = FileName(Name);
+  std::ifstream is(file);
+
+  if (!is.is_open())
+     return false;
+
+  int count = ReadTransponders(is, List, file);
+  dlog(4, "read " + IntToStr(count) + " transponders from " + file);
+  return count > 0;
+}
+
+bool SaveTransponders(std::string Name, TChannels& List) {
+  std::string file = FileName(Name);
+  std::string tmp = file + ".tmp";
+  std::ofstream os(tmp, std::ios::trunc);
+
+  if (!os.is_open()) {
+     dlog(0, "could not write " + tmp);
+     return false;
+     }
+
+  WriteTransponders(os, List, Name);
+  os.close();
+
+  if (os.fail() or rename(tmp.c_str(), file.c_str()) != 0) {
+     dlog(0, "could not write " + file);
+     return false;
+     }
+  dlog(4, "wrote " + IntToStr(List.Count()) + " transponders to " + file);
+  return true;
+}
+
+
+
+/* checkpoint, one item per line:
+ * H:Type:CountryIndex:SatIndex:Satellite:Satellites (comma separated, may be empty)
+ * J:<transponder>       still to be scanned
+ * S:<transponder>       scanned
+ * N:<transponder>       found by NIT, not yet scanned
+ * C:LCN:LCN_minor:<vdr channel>
+ */
+static std::string CheckpointFile(void) {
+  return std::string(cPlugin::ConfigDirectory("wirbelscan")) + "/checkpoint.conf";
+}
+
+void WriteCheckpoint(std::ostream& os, TCheckpoint& Header, TChannels& Jobs, TChannels& Channels, TChannels& Scanned, TChannels& Found) {
+  os << "# wirbelscan: scan checkpoint, do not edit." << std::endl;
+  os << "H:" << Header.Type << ':' << Header.CountryIndex << ':' << Header.SatIndex << ':' << Header.Satellite << ':';
+  for(size_t i=0; i<Header.Satellites.size(); i++)
+     os << (i ? "," : "") << Header.Satellites[i];
+  os << std::endl;
+
+  auto transponders = [&os](char Tag, TChannels& List) {
+     for(int idx = 0; idx < List.Count(); idx++) {
+        os << Tag << ':';
+        PrintTransponder(os, List[idx]);
+        os << std::endl;
+        }
+     };
+  transponders('J', Jobs);
+  transponders('S', Scanned);
+  transponders('N', Found);
+
+  for(int idx = 0; idx < Channels.Count(); idx++) {
+     std::string s;
+     Channels[idx]->Print(s);
+     os << "C:" << Channels[idx]->LCN << ':' << Channels[idx]->LCN_minor << ':' << s << std::endl;
+     }
+}
+
+bool SaveCheckpoint(TCheckpoint& Header, TChannels& Jobs, TChannels& Channels, TChannels& Scanned, TChannels& Found) {
+  std::string file = CheckpointFile();
+  std::string tmp = file + ".tmp";
+  std::ofstream os(tmp, std::ios::trunc);
+
+  if (!os.is_open()) {
+     dlog(0, "could not write " + tmp);
+     return false;
+     }
+
+  WriteCheckpoint(os, Header, Jobs, Channels, Scanned, Found);
+  os.close();
+
+  if (os.fail() or rename(tmp.c_str(), file.c_str()) != 0) {
+     dlog(0, "could not write " + file);
+     return false;
+     }
+  dlog(4, "checkpoint: " + IntToStr(Jobs.Count()) + " transponders left, " +
+          IntToStr(Channels.Count()) + " channels");
+  return true;
+}
+
+bool ReadCheckpoint(std::istream& is, TCheckpoint& Header, TChannels* Jobs, TCheckpointChannel Channel,
+                    TChannels* Scanned, TChannels* Found, std::string Where) {
+  std::string line;
+  bool header = false;
+
+  while(std::getline(is, line)) {
+     if (line.size() < 2 or line[0] == '#')
+        continue;
+
+     try {
+        char tag = line[0];
+        if (tag == 'H') {
+           auto items = SplitStr(line, ':');
+           if (items.size() != 6)
+              break;
+           int satellite;
+           Header.Type         = std::stoi(items[1]);
+           Header.CountryIndex = std::stoi(items[2]);
+           Header.SatIndex     = std::stoi(items[3]);
+           satellite           = std::stoi(items[4]);
+           Header.Satellites.clear();
+           if (!items[5].empty())
+              for(auto s:SplitStr(items[5], ','))
+                 Header.Satellites.push_back(std::stoi(s));
+
+           // indices into the country and satellite lists, used without further checks.
+           if (Header.CountryIndex < 0 or (size_t) Header.CountryIndex >= COUNTRY::country_count() or
+               Header.SatIndex < 0 or (size_t) Header.SatIndex >= sat_count() or satellite < 0 or
+               (size_t) satellite >= std::max(Header.Satellites.size(), (size_t) 1))
+              throw 0;
+           for(auto s:Header.Satellites)
+              if (s < 0 or (size_t) s >= sat_count())
+                 throw 0;
+           Header.Satellite = satellite;
+           header = true;
+           if (!Jobs)
+              break;
+           }
+        else if (tag == 'C') {
+           if (!Channel)
+              continue;
+           size_t p1 = line.find(':', 2);
+           size_t p2 = p1 == std::string::npos ? p1 : line.find(':', p1 + 1);
+           if (p2 == std::string::npos)
+              throw 0;
+           int lcn       = std::stoi(line.substr(2, p1 - 2));
+           int lcn_minor = std::stoi(line.substr(p1 + 1, p2 - p1 - 1));
+           if (!Channel(lcn, lcn_minor, line.substr(p2 + 1)))
+              throw 0;
+           }
+        else {
+           auto items = SplitStr(line, ':');
+           TChannels* list = tag == 'J' ? Jobs : tag == 'S' ? Scanned : tag == 'N' ? Found : nullptr;
+           if (!list)
+              continue;
+           if (items.size() != fieldcount + 1)
+              throw 0;
+           TChannel* t = ParseTransponder(items, 1);
+           t->Tested = tag == 'S';
+           list->Add(t);
+           }
+        }
+     catch(...) {
+        dlog(0, Where + ": invalid line '" + line + "'");
+        if (line[0] == 'H')
+           break;
+        }
+     }
+  return header;
+}
+
+bool LoadCheckpoint(TCheckpoint& Header, TChannels* Jobs, TChannels* Channels, TChannels* Scanned, TChannels* Found) {
+  std::string file = CheckpointFile();
+  std::ifstream is(file);
+
+  if (!is.is_open())
+     return false;
+
+  TCheckpointChannel channel;
+  if (Channels)
+     channel = [Channels](int LCN, int LCN_minor, std::string Text) -> bool {
+        cChannel c;
+        if (!c.Parse(Text.c_str()))
+           return false;
+        TChannel* t = new TChannel;
+        *t = &c;
+        t->LCN       = LCN;
+        t->LCN_minor = LCN_minor;
+        Channels->Add(t);
+        return true;
+        };
+  return ReadCheckpoint(is, Header, Jobs, channel, Scanned, Found, file);
+}
+
+void RemoveCheckpoint(void) {
+  remove(CheckpointFile().c_str());
+}
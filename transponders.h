@@ -0,0 +1,52 @@
+/*******************************************************************************
+ * wirbelscan: A plugin for the Video Disk Recorder
+ * See the README file for copyright information and how to reach the author.
+ ******************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <iostream>
+#include <functional>
+#include "common.h"   // TChannels
+
+
+/*******************************************************************************
+ * transponders learned from previous scans, one file per source in the plugins
+ * config dir. Name is the source as selected by the user, ie. 'S19E2', 'T-DE'.
+ * Items in List are owned by the caller.
+ ******************************************************************************/
+bool LoadTransponders(std::string Name, TChannels& List);
+bool SaveTransponders(std::string Name, TChannels& List);
+
+// the file format, Where/Name for messages only. Invalid lines are logged and skipped.
+int  ReadTransponders(std::istream& is, TChannels& List, std::string Where);
+void WriteTransponders(std::ostream& os, TChannels& List, std::string Name);
+
+
+/*******************************************************************************
+ * checkpoint of a running scan: the scan plans position, channels found and
+ * transponders scanned so far. Written periodically, removed after a
+ * completed scan.
+ *   Satellites: multi satellite scan, sat_list indices; Satellite is the
+ *               position in Satellites.
+ *   Jobs:       transponders still to be scanned.
+ * If only the header is needed, the lists may be nullptr.
+ ******************************************************************************/
+struct TCheckpoint {
+  int Type;
+  int CountryIndex;
+  int SatIndex;
+  size_t Satellite;
+  std::vector<int> Satellites;
+};
+
+bool SaveCheckpoint(TCheckpoint& Header, TChannels& Jobs, TChannels& Channels, TChannels& Scanned, TChannels& Found);
+bool LoadCheckpoint(TCheckpoint& Header, TChannels* Jobs = nullptr, TChannels* Channels = nullptr,
+                    TChannels* Scanned = nullptr, TChannels* Found = nullptr);
+void RemoveCheckpoint(void);
+
+// the file format. Channel, if set, gets the LCN and VDR channel text of each channel.
+typedef std::function<bool(int LCN, int LCN_minor, std::string Text)> TCheckpointChannel;
+void WriteCheckpoint(std::ostream& os, TCheckpoint& Header, TChannels& Jobs, TChannels& Channels, TChannels& Scanned, TChannels& Found);
+bool ReadCheckpoint(std::istream& is, TCheckpoint& Header, TChannels* Jobs, TCheckpointChannel Channel,
+                    TChannels* Scanned, TChannels* Found, std::string Where);
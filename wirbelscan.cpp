@@ -6,6 +6,9 @@
 #include <vector>
 #include <sstream>
 #include <cctype>        // std::toupper()
+#include <cerrno>
+#include <cstdlib>       // strtol()
+#include <map>
 #include <vdr/plugin.h>
 #include <vdr/i18n.h>
 #include "common.h"      // wSetup
@@ -14,6 +17,7 @@
 #include "menusetup.h"
 #include "countries.h"
 #include "satellites.h"
+#include "scanstats.h"    // ScanStats
 
 class cScanner;
 
@@ -121,6 +125,8 @@ bool cPluginWirbelscan::SetupParse(const char* Name, const char* Value) {
   else if (name == "ParseLCN")         wSetup.ParseLCN             = std::stol(Value) != 0;
   else if (name == "SignalWaitTime")   wSetup.SignalWaitTime       = constrain(std::stoi(Value), 1, 5);
   else if (name == "LockTimeout")      wSetup.LockTimeout          = constrain(std::stoi(Value), 1, 10);
+  else if (name == "ParallelScan")     wSetup.ParallelScan         = constrain(std::stoi(Value), 0, 1);
+  else if (name == "TransponderDB")    wSetup.TransponderDB        = constrain(std::stoi(Value), 0, 2);
   else if (name == "preferred") {
      auto items = SplitStr(Value,';');
      for(size_t i=0; i<std::min(items.size(),wSetup.preferred.size()); i++)
@@ -160,6 +166,8 @@ void cPluginWirbelscan::StoreSetup(void) {
   SetupStore("an",              wSetup.scan_append_new);
   SetupStore("SignalWaitTime",  wSetup.SignalWaitTime);
   SetupStore("LockTimeout",     wSetup.LockTimeout);
+  SetupStore("ParallelScan",    wSetup.ParallelScan);
+  SetupStore("TransponderDB",   wSetup.TransponderDB);
   SetupStore("preferred",       preferred.c_str());
   Setup.Save();
 }
@@ -182,6 +190,7 @@ int cPluginWirbelscan::servicetype(const char* id, bool init) {
      services.push_back(s + "Get" + SUser);
      services.push_back(s + "Set" + SUser);
      services.push_back(s +       + SExport);
+     services.push_back(s + "Get" + SStats);
      }
 
   for(size_t i=0; i<services.size(); i++) {
@@ -241,6 +250,9 @@ bool cPluginWirbelscan::Service(const char* id, void* Data) {
               StoreSetup();
               request->replycode = true;
               break;
+           case CmdResumeScan:
+              request->replycode = DoResume();
+              break;
            default:
               request->replycode = false;
               return false;
@@ -342,11 +354,31 @@ bool cPluginWirbelscan::Service(const char* id, void* Data) {
         }
      case 9: { // Export
         if (! Data) return true; // check for support
-        extern TChannels NewChannels;
+        extern cChannelList NewChannels;
         std::vector<TChannel>* list = (std::vector<TChannel>*) Data;
-        for(int idx = 0; idx < NewChannels.Count(); ++idx) {
-           TChannel t = *NewChannels[idx];
-           list->push_back(t);
+        NewChannels.ForEach([list](TChannel* n) {
+           list->push_back(*n);
+           });
+        return true;
+        }
+     case 10: { // get stats
+        if (! Data) return true; // check for support
+        cStatsBuffer* b = (cStatsBuffer*) Data;
+        std::vector<THistogram> histograms = ScanStats.Histograms();
+        b->count = 0;
+        if (b->size < histograms.size()) {
+           b->size = histograms.size();
+           return true;
+           }
+        for(auto& h:histograms) {
+           SStatsItem* l = &b->buffer[b->count++];
+           memset(l, 0, sizeof(SStatsItem));
+           strncpy(l->name, h.name.c_str(), sizeof(l->name) - 1);
+           l->count = h.count;
+           l->total = h.total;
+           l->max   = h.max;
+           for(int i = 0; i < THistogram::Buckets; i++)
+              l->histogram[i] = h.buckets[i];
            }
         return true;
         }
@@ -361,12 +393,19 @@ const char** cPluginWirbelscan::SVDRPHelpPages(void) {
     "    Start scan",
     "S_STOP\n"
     "    Stop scan(s) (if any)",
+    "S_RESUME\n"
+    "    Continue an interrupted scan from its last checkpoint",
     "S_TERR\n"
     "    Start DVB-T scan",
     "S_CABL\n"
     "    Start DVB-C scan",
     "S_SAT\n"
     "    Start DVB-S/S2 scan",
+    "S_SATS <sat[=rotor]>[,<sat[=rotor]>...]\n"
+    "    Start DVB-S/S2 scan of several satellites, ordered by rotor\n"
+    "    position (if given for all of them) or orbital position.\n"
+    "    sat    satellite short name, see LSTS\n"
+    "    rotor  rotor position of this satellite (0..255), this scan only",
     "SETUP <verb:log:type:inv_t:inv_c:srate:qam:cidx:sidx:s2:atsc:flags>\n"
     "    verb   verbostity (0..5)\n"
     "    log    logfile (0=OFF, 1=stdout, 2=syslog)\n"
@@ -394,6 +433,11 @@ const char** cPluginWirbelscan::SVDRPHelpPages(void) {
     "    list satellites",
     "QUERY\n"
     "    return plugin version, current setup and service versions",
+    "STATS [TP]\n"
+    "    timing of the current or last scan: count, total, average, max\n"
+    "    and histogram in msec per state, signal/lock wait, section filter\n"
+    "    and adding the channels to VDR.\n"
+    "    TP     one line per transponder instead, slowest first",
     nullptr
     };
   return SVDRHelp;
@@ -407,6 +451,43 @@ cString cPluginWirbelscan::SVDRPCommand(const char* Command, const char* Option,
   else if (cmd == "S_CABL" ) { return DoScan(wSetup.DVB_Type = SCAN_CABLE)         ? "DVB-C scan started"     : "Could not start DVB-C scan.";    }
   else if (cmd == "S_SAT"  ) { return DoScan(wSetup.DVB_Type = SCAN_SATELLITE)     ? "DVB-S scan started"     : "Could not start DVB-S scan.";    }
   else if (cmd == "S_START") { return DoScan(wSetup.DVB_Type)              ? "starting scan"          : "Could not start scan.";          }
+  else if (cmd == "S_SATS" ) {
+     std::vector<std::string> items;
+     std::vector<int> sats;
+     std::map<int,int> rotor;
+     if (Option and *Option) items = SplitStr(Option, ',');
+
+     for(auto i:items) {
+        std::vector<std::string> s = SplitStr(i, '=');
+        int idx = s.empty() ? -1 : txt_to_satellite(s[0]);
+        bool valid = idx >= 0 and s.size() <= 2;
+        if (valid and s.size() == 2) {
+           // DiSEqC 1.2 stored positions.
+           char* end = nullptr;
+           errno = 0;
+           long pos = strtol(s[1].c_str(), &end, 10);
+           valid = !s[1].empty() and *end == 0 and errno == 0 and pos >= 0 and pos <= 255;
+           rotor[idx] = pos;
+           }
+        if (!valid) {
+           ReplyCode = 501;
+           return ("couldnt parse satellite '" + i + "'.").c_str();
+           }
+        sats.push_back(idx);
+        }
+     if (sats.empty()) {
+        ReplyCode = 501;
+        return "missing satellite list.";
+        }
+     wSetup.SatList = sats;
+     wSetup.SatRotor = rotor;
+     if (DoScan(wSetup.DVB_Type = SCAN_SATELLITE))
+        return ("DVB-S scan of " + IntToStr(sats.size()) + " satellites started").c_str();
+     wSetup.SatList.clear();
+     wSetup.SatRotor.clear();
+     return "Could not start DVB-S scan.";
+     }
+  else if (cmd == "S_RESUME") { return DoResume()                  ? "resuming scan"          : "Could not resume scan.";         }
   else if (cmd == "S_STOP" ) { DoStop();       return "stopping scan(s)";  }
   else if (cmd == "STORE"  ) { StoreSetup();   return "setup stored.";     }
 
@@ -474,10 +555,20 @@ cString cPluginWirbelscan::SVDRPCommand(const char* Command, const char* Option,
          "setup api:      " + std::string(SSetup)   + "\n"
          "country api:    " + std::string(SCountry) + "\n"
          "sat api:        " + std::string(SSat)     + "\n"
-         "user api:       " + std::string(SUser);
+         "user api:       " + std::string(SUser)    + "\n"
+         "stats api:      " + std::string(SStats);
      return s.c_str();
      }
 
+  else if (cmd == "STATS") {
+     std::string opt(Option ? UpperCase(Option) : "");
+     if (!opt.empty() and opt != "TP") {
+        ReplyCode = 501;
+        return "unknown option.";
+        }
+     return ScanStats.Report(opt == "TP").c_str();
+     }
+
   else if (cmd == "LSTC") {
      std::stringstream ss;
      for(size_t i=0; i<COUNTRY::country_count(); i++)
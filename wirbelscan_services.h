@@ -29,7 +29,8 @@ namespace WIRBELSCAN_SERVICE {
 #define SCountry "Country#0001"    // get list of country IDs and Names
 #define SSat     "Sat#0001"        // get list of satellite IDs and Names
 #define SUser    "User#0002"       // get/set single user transponder, GetUser#XXXX/SetUser#XXXX
-#define SExport  "Export#0001"     // raw data export
+#define SExport  "Export#0002"     // raw data export, std::vector<TChannel>
+#define SStats   "Stats#0001"      // timing of the current or last scan, GetStats#XXXX
 
 /* --- wirbelscan_GetVersion -------------------------------------------------
  * Query wirbelscans versions, will fail only if plugin version doesnt support service at all.
@@ -55,6 +56,7 @@ typedef enum {
   CmdStartScan = 0,                              // start scanning
   CmdStopScan  = 1,                              // stop scanning
   CmdStore     = 2,                              // store current setup
+  CmdResumeScan = 3,                             // continue an interrupted scan from its last checkpoint
 } s_cmd;
 
 typedef struct {
@@ -131,6 +133,29 @@ typedef struct {
   SListItem* buffer;
 } cPreAllocBuffer;
 
+/* --- wirbelscan_GetStats --------------------------------------------------
+ * Query where the time of the current or last scan was spent: one item per
+ * state machine state ("Tune", "PAT", "PMT", "NIT", "SDT", "AddChannels", ..),
+ * "Lock" for the wait for lock and "<table> filter" for section filter lifetimes,
+ * "Probe" and "Scan lock" for the scanners signal and lock waits, "Add to VDR"
+ * for adding the channels to VDRs list at the end.
+ * All times in msec. Buffer handling as for wirbelscan_GetCountry.
+ */
+
+typedef struct {
+  char     name[24];                             // state or filter name
+  uint64_t total;                                // sum of all samples
+  uint32_t count;                                // number of samples
+  uint32_t max;                                  // longest sample
+  uint32_t histogram[12];                        // samples up to 10, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 60000 msec, above
+} SStatsItem;
+
+typedef struct {
+  uint32_t size;
+  uint32_t count;
+  SStatsItem* buffer;
+} cStatsBuffer;
+
 /* --- wirbelscan_GetUser, wirbelscan_SetUser --------------------------------
  * Scan a user defined Transponder. Service() expects a pointer to uint32_t Data[3];
  * Data should be initialized and read using class cUserTransponder.